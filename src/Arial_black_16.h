@@ -163,4 +163,22 @@ const static uint8_t Arial_Black_16[] PROGMEM = {
     
 };
 
+// Glyph offset table for DMD::selectFont(Arial_Black_16, Arial_Black_16_offsets):
+// byte index of each character's data inside Arial_Black_16, generated from
+// the width table above as 6 + char count + 2 * (sum of preceding widths).
+const static uint16_t Arial_Black_16_offsets[] PROGMEM = {
+    0x0066, 0x0066, 0x006C, 0x007A, 0x0090, 0x00A2, 0x00BE, 0x00D4,
+    0x00DA, 0x00E4, 0x00EE, 0x00FA, 0x010C, 0x0112, 0x011C, 0x0122,
+    0x012A, 0x013A, 0x0146, 0x0156, 0x0166, 0x0178, 0x0188, 0x0198,
+    0x01A8, 0x01B8, 0x01C8, 0x01CE, 0x01D4, 0x01E6, 0x01F6, 0x0208,
+    0x0218, 0x0230, 0x0248, 0x025A, 0x026C, 0x027E, 0x0290, 0x02A0,
+    0x02B4, 0x02C8, 0x02CE, 0x02E0, 0x02F8, 0x0308, 0x0320, 0x0334,
+    0x0348, 0x035A, 0x036E, 0x0382, 0x0394, 0x03AA, 0x03BE, 0x03D6,
+    0x03F6, 0x040E, 0x0424, 0x0436, 0x0440, 0x0448, 0x0452, 0x0462,
+    0x0472, 0x0478, 0x048A, 0x049C, 0x04AE, 0x04C0, 0x04D2, 0x04DE,
+    0x04F0, 0x0502, 0x0508, 0x0510, 0x0524, 0x052A, 0x0544, 0x0556,
+    0x0568, 0x057A, 0x058C, 0x0598, 0x05A8, 0x05B4, 0x05C6, 0x05D8,
+    0x05F6, 0x060C, 0x061E, 0x062C, 0x0638, 0x063C, 0x0648, 0x065A
+};
+
 #endif
\ No newline at end of file
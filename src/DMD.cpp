@@ -1,16 +1,76 @@
+#include <avr/interrupt.h>
 #include "DMD.h"
 
-DMD::DMD(uint8_t panelsWide, uint8_t panelsHigh)
+// RAM distance between horizontally adjacent bytes (8 pixels apart)
+#if DMD_SCAN_ORDER_RAM
+#define DMD_RAM_STEP_X  4
+#else
+#define DMD_RAM_STEP_X  1
+#endif
+
+// Byte-wide form of the writePixel() graphics modes. For a framebuffer byte b,
+// 'cover' marks the pixels being drawn and 'ink' the ones that are set:
+//   b = ((b & ~clr) | set) ^ tog
+// with clr/set/tog built from cover and ink by the masks below, so the mode is
+// resolved once per call instead of once per pixel.
+struct DMDRasterOp {
+    uint8_t clrCover, clrInk;   // clear: covered pixels / set pixels
+    uint8_t setBg, setInk;      // set:   covered but unset pixels / set pixels
+    uint8_t toggle;             // flip:  set pixels
+};
+
+static inline DMDRasterOp dmdRasterOp(uint8_t bGraphicsMode)
 {
+    DMDRasterOp op = { 0, 0, 0, 0, 0 };
+    switch (bGraphicsMode) {
+    case GRAPHICS_NORMAL:  op.clrCover = 0xFF; op.setBg = 0xFF; break;
+    case GRAPHICS_INVERSE: op.clrCover = 0xFF; op.setInk = 0xFF; break;
+    case GRAPHICS_TOGGLE:  op.toggle = 0xFF; break;
+    case GRAPHICS_OR:      op.clrInk = 0xFF; break;
+    case GRAPHICS_NOR:     op.setInk = 0xFF; break;
+    }
+    return op;
+}
+
+static inline uint8_t dmdBlend(uint8_t b, uint8_t cover, uint8_t ink, const DMDRasterOp &op)
+{
+    uint8_t clr = (cover & op.clrCover) | (ink & op.clrInk);
+    uint8_t set = (cover & ~ink & op.setBg) | (ink & op.setInk);
+    return ((b & ~clr) | set) ^ (ink & op.toggle);
+}
+
+#if DMD_FIXED_GEOMETRY
+static uint8_t dmdStaticRAM[DMD_STATIC_BUFFERS][DMD_STATIC_BUFFER_BYTES];
+#endif
+
+DMD::DMD(uint8_t panelsWide, uint8_t panelsHigh, bool doubleBuffered)
+{
+#if DMD_FIXED_GEOMETRY
+    (void) panelsWide;
+    (void) panelsHigh;
+
+    bDMDScreenRAM = dmdStaticRAM[0];
+    bDMDScanRAM = (doubleBuffered && DMD_STATIC_BUFFERS > 1) ? dmdStaticRAM[DMD_STATIC_BUFFERS - 1] : bDMDScreenRAM;
+#else
     DisplaysWide = panelsWide;
     DisplaysHigh = panelsHigh;
     DisplaysTotal = DisplaysWide * DisplaysHigh;
     row1 = DisplaysTotal << 4;
     row2 = DisplaysTotal << 5;
     row3 = ((DisplaysTotal << 2) * 3) << 2;
-    
+
+
     // Allocate RAM using malloc (standard C)
     bDMDScreenRAM = (uint8_t *) malloc(DisplaysTotal * DMD_RAM_SIZE_BYTES);
+    bDMDScanRAM = doubleBuffered ? (uint8_t *) malloc(DisplaysTotal * DMD_RAM_SIZE_BYTES) : bDMDScreenRAM;
+    if (bDMDScanRAM == NULL) {
+        // Not enough heap for a back buffer, fall back to single buffering
+        bDMDScanRAM = bDMDScreenRAM;
+    }
+#endif
+    bDoubleBuffered = (bDMDScanRAM != bDMDScreenRAM);
+    bSwapPending = false;
+    dirtyX1 = 1; dirtyX2 = 0; dirtyY1 = 1; dirtyY2 = 0;
 
     // 1. SETUP GPIO (BARE METAL)
     // Set Direction Registers to OUTPUT (1)
@@ -24,9 +84,18 @@ DMD::DMD(uint8_t panelsWide, uint8_t panelsHigh)
 
     // 2. SETUP SPI (BARE METAL)
     spi_init_bare();
+    scanStartTicks = 0;
+    scanTicksMax = 0;
 
+    // Blank both buffers so the first swap never shows garbage
     clearScreen(true);
+    if (bDoubleBuffered) {
+        memset(bDMDScanRAM, 0xFF, DMD_RAM_SIZE_BYTES * DisplaysTotal);
+    }
     bDMDByte = 0;
+    Font = NULL;
+    FontOffsets = NULL;
+    marqueeStrip = NULL;
 }
 
 void DMD::spi_init_bare() {
@@ -34,6 +103,9 @@ void DMD::spi_init_bare() {
     // SPE: SPI Enable
     // MSTR: Master Select
     // SPR0: Clock Divide (Optional, default div 4)
+    // Rows go out as a polled burst from the Timer1 ISR: at fck/2 a byte is
+    // 16 cycles on the wire, less than an SPI_STC_vect entry and exit, so an
+    // interrupt per byte would cost more CPU than it frees
     SPCR = (1 << SPE) | (1 << MSTR); 
     SPSR = (1 << SPI2X); // Double speed (fck/2) -> Max speed for P10
 }
@@ -43,6 +115,39 @@ inline void DMD::spi_transfer_bare(uint8_t data) {
     while (!(SPSR & (1 << SPIF))); // Wait for transmission complete
 }
 
+// Byte holding pixel (bX, bY), where bX already includes the panel offset
+// (panel << 5) and bY is the row inside the panel (0..15).
+inline unsigned int DMD::ramIndex(unsigned int bX, unsigned int bY)
+{
+#if DMD_SCAN_ORDER_RAM
+    // Phase (bY & 3) is one run of row1 bytes; inside it every byte column
+    // sends rows 12+p, 8+p, 4+p, p in that order.
+    return (bY & 3) * row1 + ((bX >> 3) << 2) + (3 - (bY >> 2));
+#else
+    return bX / 8 + bY * (DisplaysTotal << 2);
+#endif
+}
+
+// Byte holding screen pixel (x, y). Panels in a chain row are consecutive in
+// RAM, so x only needs the offset of the panel row.
+inline uint8_t *DMD::screenByte(unsigned int x, unsigned int y)
+{
+    x += (DisplaysWide * (y / DMD_PIXELS_DOWN)) << 5;
+    return &bDMDScreenRAM[ramIndex(x, y % DMD_PIXELS_DOWN)];
+}
+
+inline void DMD::markDirty(int x1, int y1, int x2, int y2)
+{
+    if (dirtyX1 > dirtyX2) {
+        dirtyX1 = x1; dirtyY1 = y1; dirtyX2 = x2; dirtyY2 = y2;
+        return;
+    }
+    if (x1 < dirtyX1) dirtyX1 = x1;
+    if (y1 < dirtyY1) dirtyY1 = y1;
+    if (x2 > dirtyX2) dirtyX2 = x2;
+    if (y2 > dirtyY2) dirtyY2 = y2;
+}
+
 void DMD::writePixel(unsigned int bX, unsigned int bY, uint8_t bGraphicsMode, uint8_t bPixel)
 {
     unsigned int uiDMDRAMPointer;
@@ -50,11 +155,12 @@ void DMD::writePixel(unsigned int bX, unsigned int bY, uint8_t bGraphicsMode, ui
     if (bX >= (DMD_PIXELS_ACROSS * DisplaysWide) || bY >= (DMD_PIXELS_DOWN * DisplaysHigh)) {
         return;
     }
+    markDirty(bX, bY, bX, bY);
     uint8_t panel = (bX / DMD_PIXELS_ACROSS) + (DisplaysWide * (bY / DMD_PIXELS_DOWN));
     bX = (bX % DMD_PIXELS_ACROSS) + (panel << 5);
     bY = bY % DMD_PIXELS_DOWN;
     
-    uiDMDRAMPointer = bX / 8 + bY * (DisplaysTotal << 2);
+    uiDMDRAMPointer = ramIndex(bX, bY);
     uint8_t lookup = bPixelLookupTable[bX & 0x07];
 
     switch (bGraphicsMode) {
@@ -98,16 +204,60 @@ void DMD::scanDisplayBySPI()
         return; 
     }
 
+    // Vsync: exchange front and back buffer only at the start of a frame,
+    // so a frame is never shown half old, half new
+    if (bSwapPending && bDMDByte == 0) {
+        uint8_t *tmp = bDMDScanRAM;
+        bDMDScanRAM = bDMDScreenRAM;
+        bDMDScreenRAM = tmp;
+        bSwapPending = false;
+    }
+
+    scanStartTicks = TCNT1;
+
+#if DMD_SCAN_ORDER_RAM
+    // Phase bDMDByte is row1 contiguous bytes already in shift-out order
+    const uint8_t *ram = bDMDScanRAM + bDMDByte * row1;
+
+    for (int n = row1; n; n--) {
+        spi_transfer_bare(*ram++);
+    }
+#else
     int rowsize = DisplaysTotal << 2;
     int offset = rowsize * bDMDByte;
+    const uint8_t *ram = bDMDScanRAM;
 
     // SPI Transfer Loop
     for (int i = 0; i < rowsize; i++) {
-        spi_transfer_bare(bDMDScreenRAM[offset + i + row3]);
-        spi_transfer_bare(bDMDScreenRAM[offset + i + row2]);
-        spi_transfer_bare(bDMDScreenRAM[offset + i + row1]);
-        spi_transfer_bare(bDMDScreenRAM[offset + i]);
+        spi_transfer_bare(ram[offset + i + row3]);
+        spi_transfer_bare(ram[offset + i + row2]);
+        spi_transfer_bare(ram[offset + i + row1]);
+        spi_transfer_bare(ram[offset + i]);
     }
+#endif
+
+    latchRow();
+}
+
+void DMD::scanStats(DMDScanStats &stats)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t ticksMax = scanTicksMax;
+    SREG = oldSREG;
+
+    stats.panels = DisplaysTotal;
+    stats.bytesPerRow = DisplaysTotal * 16;
+    stats.rowCyclesMax = ticksMax * DMD_SCAN_TICK_CYCLES;
+}
+
+inline void DMD::latchRow()
+{
+    // Row time in Timer1 ticks; TCNT1 restarts at OCR1A in CTC mode
+    uint16_t now = TCNT1;
+    if (now < scanStartTicks) now += OCR1A + 1;
+    now -= scanStartTicks;
+    if (now > scanTicksMax) scanTicksMax = now;
 
     OE_DMD_ROWS_OFF();
     LATCH_DMD_SHIFT_REG_TO_OUTPUT();
@@ -121,19 +271,76 @@ void DMD::scanDisplayBySPI()
     OE_DMD_ROWS_ON();
 }
 
+void DMD::swapBuffers(bool keepContent)
+{
+    if (bDoubleBuffered) {
+        bSwapPending = true;
+        if (!(SREG & (1 << SREG_I))) {
+            // Interrupts are off, the scan ISR can't pick the swap up: do it now
+            uint8_t *tmp = bDMDScanRAM;
+            bDMDScanRAM = bDMDScreenRAM;
+            bDMDScreenRAM = tmp;
+            bSwapPending = false;
+        }
+        while (bSwapPending); // at most one frame (4 scan rows)
+
+        // bDMDScreenRAM was changed behind the compiler's back by the ISR
+        __asm__ __volatile__("" ::: "memory");
+
+        // The new back buffer is two frames old: bring over only the bytes
+        // touched since the last swap
+        if (keepContent && dirtyX1 <= dirtyX2) {
+            uint8_t bytes = (dirtyX2 >> 3) - (dirtyX1 >> 3) + 1;
+            for (int y = dirtyY1; y <= dirtyY2; y++) {
+                unsigned int o = screenByte(dirtyX1, y) - bDMDScreenRAM;
+                for (uint8_t n = bytes; n; n--) {
+                    bDMDScreenRAM[o] = bDMDScanRAM[o];
+                    o += DMD_RAM_STEP_X;
+                }
+            }
+        }
+    }
+    dirtyX1 = 1; dirtyX2 = 0;
+}
+
 void DMD::clearScreen(uint8_t bNormal)
 {
+    markDirty(0, 0, DMD_PIXELS_ACROSS * DisplaysWide - 1, DMD_PIXELS_DOWN * DisplaysHigh - 1);
     if (bNormal)
         memset(bDMDScreenRAM, 0xFF, DMD_RAM_SIZE_BYTES * DisplaysTotal);
     else
         memset(bDMDScreenRAM, 0x00, DMD_RAM_SIZE_BYTES * DisplaysTotal);
 }
 
-void DMD::selectFont(const uint8_t * font) {
+void DMD::clearRect(int x1, int y1, int x2, int y2, uint8_t bNormal)
+{
+    if (x1 > x2) { int t = x1; x1 = x2; x2 = t; }
+    if (y1 > y2) { int t = y1; y1 = y2; y2 = t; }
+    fillRect(x1, y1, x2, y2, bNormal ? GRAPHICS_INVERSE : GRAPHICS_NORMAL);
+}
+
+void DMD::selectFont(const uint8_t * font, const uint16_t * glyphOffsets) {
     this->Font = font;
+    this->FontOffsets = glyphOffsets;
+}
+
+// Text is read in place, from SRAM or from flash
+static inline unsigned char dmdTextChar(const char *bChars, bool progmem, uint8_t i)
+{
+    return progmem ? pgm_read_byte(bChars + i) : bChars[i];
 }
 
 void DMD::drawString(int bX, int bY, const char *bChars, uint8_t length, uint8_t bGraphicsMode)
+{
+    drawStringFrom(bX, bY, bChars, false, length, bGraphicsMode);
+}
+
+void DMD::drawString_P(int bX, int bY, const char *bChars, uint8_t length, uint8_t bGraphicsMode)
+{
+    drawStringFrom(bX, bY, bChars, true, length, bGraphicsMode);
+}
+
+void DMD::drawStringFrom(int bX, int bY, const char *bChars, bool progmem, uint8_t length, uint8_t bGraphicsMode)
 {
     if (bX >= (DMD_PIXELS_ACROSS * DisplaysWide) || bY >= DMD_PIXELS_DOWN * DisplaysHigh) return;
     uint8_t height = pgm_read_byte(this->Font + FONT_HEIGHT);
@@ -143,7 +350,7 @@ void DMD::drawString(int bX, int bY, const char *bChars, uint8_t length, uint8_t
     this->drawLine(bX - 1, bY, bX - 1, bY + height, GRAPHICS_INVERSE);
 
     for (int i = 0; i < length; i++) {
-        int charWide = this->drawChar(bX + strWidth, bY, bChars[i], bGraphicsMode);
+        int charWide = this->drawChar(bX + strWidth, bY, dmdTextChar(bChars, progmem, i), bGraphicsMode);
         if (charWide > 0) {
             strWidth += charWide;
             this->drawLine(bX + strWidth, bY, bX + strWidth, bY + height, GRAPHICS_INVERSE);
@@ -155,37 +362,56 @@ void DMD::drawString(int bX, int bY, const char *bChars, uint8_t length, uint8_t
     }
 }
 
-int DMD::drawChar(const int bX, const int bY, const unsigned char letter, uint8_t bGraphicsMode)
+// Byte index and width of a (non-space) character in the current font
+bool DMD::findGlyph(unsigned char c, uint16_t &index, uint8_t &width)
 {
-    if (bX > (DMD_PIXELS_ACROSS * DisplaysWide) || bY > (DMD_PIXELS_DOWN * DisplaysHigh)) return -1;
-    unsigned char c = letter;
-    uint8_t height = pgm_read_byte(this->Font + FONT_HEIGHT);
-    if (c == ' ') {
-        int charWide = charWidth(' ');
-        this->drawFilledBox(bX, bY, bX + charWide, bY + height, GRAPHICS_INVERSE);
-        return charWide;
-    }
-    uint8_t width = 0;
-    uint8_t bytes = (height + 7) / 8;
+    uint8_t bytes = (pgm_read_byte(this->Font + FONT_HEIGHT) + 7) / 8;
     uint8_t firstChar = pgm_read_byte(this->Font + FONT_FIRST_CHAR);
     uint8_t charCount = pgm_read_byte(this->Font + FONT_CHAR_COUNT);
-    uint16_t index = 0;
 
-    if (c < firstChar || c >= (firstChar + charCount)) return 0;
+    if (c < firstChar || c >= (firstChar + charCount)) return false;
     c -= firstChar;
 
     if (pgm_read_byte(this->Font + FONT_LENGTH) == 0 && pgm_read_byte(this->Font + FONT_LENGTH + 1) == 0) {
         width = pgm_read_byte(this->Font + FONT_FIXED_WIDTH);
         index = c * bytes * width + FONT_WIDTH_TABLE;
+    } else if (this->FontOffsets) {
+        index = pgm_read_word(this->FontOffsets + c);
+        width = pgm_read_byte(this->Font + FONT_WIDTH_TABLE + c);
     } else {
+        index = 0;
         for (uint8_t i = 0; i < c; i++) {
             index += pgm_read_byte(this->Font + FONT_WIDTH_TABLE + i);
         }
         index = index * bytes + charCount + FONT_WIDTH_TABLE;
         width = pgm_read_byte(this->Font + FONT_WIDTH_TABLE + c);
     }
+    return true;
+}
+
+int DMD::drawChar(const int bX, const int bY, const unsigned char letter, uint8_t bGraphicsMode)
+{
+    if (bX > (DMD_PIXELS_ACROSS * DisplaysWide) || bY > (DMD_PIXELS_DOWN * DisplaysHigh)) return -1;
+    unsigned char c = letter;
+    uint8_t height = pgm_read_byte(this->Font + FONT_HEIGHT);
+    if (c == ' ') {
+        int charWide = charWidth(' ');
+        this->drawFilledBox(bX, bY, bX + charWide, bY + height, GRAPHICS_INVERSE);
+        return charWide;
+    }
+    uint8_t width = 0;
+    uint8_t bytes = (height + 7) / 8;
+    uint16_t index = 0;
+
+    if (!findGlyph(c, index, width)) return 0;
     if (bX < -width || bY < -height) return width;
 
+    if (height < 32) {
+        blitGlyph(bX, bY, index, width, bytes, height, bGraphicsMode);
+        return width;
+    }
+
+    // Taller fonts than the blitter's row buffer: per-pixel path
     for (uint8_t j = 0; j < width; j++) { 
         for (uint8_t i = bytes - 1; i < 254; i--) { 
             uint8_t data = pgm_read_byte(this->Font + index + j + (i * width));
@@ -205,6 +431,100 @@ int DMD::drawChar(const int bX, const int bY, const unsigned char letter, uint8_
     return width;
 }
 
+// Last glyph row drawn by the original per-pixel loop: single-byte fonts also
+// write bit 7 (row 'height' for a 7 row font), the last byte of taller fonts
+// is bottom-aligned to the glyph height.
+static inline uint8_t dmdGlyphLastRow(uint8_t bytes, uint8_t height)
+{
+    return (bytes == 1) ? ((height < 7) ? height : 7) : height - 1;
+}
+
+// Transposes glyph columns j0..j0+w8-1 into rows[0..lastRow] (bit 7 = column
+// j0). Each font byte is read from PROGMEM once.
+static void dmdGlyphRows(const uint8_t *glyph, uint8_t width, uint8_t bytes, uint8_t height,
+                         uint8_t j0, uint8_t w8, uint8_t *rows)
+{
+    uint8_t lastRow = dmdGlyphLastRow(bytes, height);
+    uint8_t lastBase = (bytes > 1) ? height - 8 : 0;
+
+    memset(rows, 0, lastRow + 1);
+    for (uint8_t j = 0; j < w8; j++) {
+        uint8_t mask = 0x80 >> j;
+        for (uint8_t i = 0; i < bytes; i++) {
+            uint8_t data = pgm_read_byte(glyph + j0 + j + (i * width));
+            uint8_t base = (i == bytes - 1) ? lastBase : i * 8;
+            uint8_t k = (base < i * 8) ? i * 8 - base : 0;
+            data >>= k;
+            for (uint8_t r = base + k; k < 8 && r <= lastRow; k++, r++) {
+                if (data & 1) rows[r] |= mask;
+                data >>= 1;
+            }
+        }
+    }
+}
+
+// Draws a glyph 8 columns at a time: the columns are transposed into per-row
+// masks, which are then merged into the framebuffer a byte at a time. Touches
+// exactly the pixels the per-pixel loop did.
+void DMD::blitGlyph(int bX, int bY, uint16_t index, uint8_t width, uint8_t bytes, uint8_t height, uint8_t bGraphicsMode)
+{
+    uint8_t lastRow = dmdGlyphLastRow(bytes, height);
+    int pixelsWide = DMD_PIXELS_ACROSS * DisplaysWide;
+    int pixelsHigh = DMD_PIXELS_DOWN * DisplaysHigh;
+
+    // Clip rows once for the whole glyph
+    int rFirst = (bY < 0) ? -bY : 0;
+    int rLast = pixelsHigh - 1 - bY;
+    if (rLast > lastRow) rLast = lastRow;
+    if (rFirst > rLast) return;
+
+    int xFirst = (bX < 0) ? 0 : bX;
+    int xLast = bX + width - 1;
+    if (xLast >= pixelsWide) xLast = pixelsWide - 1;
+    if (xFirst > xLast) return;
+    markDirty(xFirst, bY + rFirst, xLast, bY + rLast);
+
+    DMDRasterOp op = dmdRasterOp(bGraphicsMode);
+    const uint8_t *glyph = this->Font + index;
+    uint8_t rows[32];
+
+    for (uint8_t j0 = 0; j0 < width; j0 += 8) {
+        int x0 = bX + j0;
+        if (x0 >= pixelsWide) break;
+
+        uint8_t w8 = width - j0;
+        if (w8 > 8) w8 = 8;
+        if (x0 + w8 <= 0) continue;
+
+        // Clip columns: bit 7 is column j0
+        uint8_t cover = 0xFF << (8 - w8);
+        uint8_t shiftL = 0;
+        if (x0 < 0) {
+            shiftL = -x0;
+            cover &= 0xFF >> shiftL;
+            x0 = 0;
+        }
+        if (x0 + 8 - shiftL > pixelsWide) {
+            cover &= 0xFF << (x0 + 8 - shiftL - pixelsWide);
+        }
+        uint8_t shiftR = x0 & 7;
+        uint16_t coverW = (uint16_t)(uint8_t)(cover << shiftL) << 8 >> shiftR;
+
+        dmdGlyphRows(glyph, width, bytes, height, j0, w8, rows);
+
+        for (int r = rFirst; r <= rLast; r++) {
+            uint8_t y = bY + r;
+            uint16_t inkW = (uint16_t)(uint8_t)((rows[r] & cover) << shiftL) << 8 >> shiftR;
+            uint8_t *p = screenByte(x0, y);
+            *p = dmdBlend(*p, coverW >> 8, inkW >> 8, op);
+            if ((uint8_t)coverW) {
+                p += DMD_RAM_STEP_X;
+                *p = dmdBlend(*p, coverW, inkW, op);
+            }
+        }
+    }
+}
+
 int DMD::charWidth(const unsigned char letter) {
     unsigned char c = letter;
     if (c == ' ') c = 'n';
@@ -223,18 +543,191 @@ int DMD::charWidth(const unsigned char letter) {
     return width;
 }
 
+void DMD::beginTextField(DMDTextField &field, int bX, int bY, uint8_t bGraphicsMode) {
+    field.x = bX;
+    field.y = bY;
+    field.graphicsMode = bGraphicsMode;
+    field.length = 0;
+    field.font = this->Font;
+    field.fontOffsets = this->FontOffsets;
+}
+
+// Redraws only what differs from the field's current text: changed glyphs in
+// place while the layout stays the same, otherwise everything from the first
+// difference on. Spacing matches drawString().
+void DMD::updateTextField(DMDTextField &field, const char *bChars, uint8_t length) {
+    if (length > DMD_TEXT_FIELD_MAX) length = DMD_TEXT_FIELD_MAX;
+
+    const uint8_t *prevFont = this->Font;
+    const uint16_t *prevOffsets = this->FontOffsets;
+    selectFont(field.font, field.fontOffsets);
+    uint8_t height = pgm_read_byte(this->Font + FONT_HEIGHT);
+    uint8_t mode = field.graphicsMode;
+
+    // Unchanged prefix stays on screen
+    int x = field.x;
+    uint8_t first = 0;
+    while (first < length && first < field.length && bChars[first] == field.text[first]) {
+        int w = charWidth(bChars[first]);
+        if (w > 0) x += w + 1;
+        first++;
+    }
+
+    // Same length and same glyph widths: positions don't move
+    bool inPlace = (length == field.length);
+    int oldEnd = x;
+    for (uint8_t i = first; i < field.length; i++) {
+        int w = charWidth(field.text[i]);
+        if (inPlace && w != charWidth(bChars[i])) inPlace = false;
+        if (w > 0) oldEnd += w + 1;
+    }
+
+    if (inPlace) {
+        for (uint8_t i = first; i < length; i++) {
+            int w = charWidth(bChars[i]);
+            if (bChars[i] != field.text[i] && w > 0) {
+                clearRect(x, field.y, x + w - 1, field.y + height, true);
+                drawChar(x, field.y, bChars[i], mode);
+            }
+            if (w > 0) x += w + 1;
+        }
+    } else {
+        if (oldEnd > x) clearRect(x, field.y, oldEnd - 1, field.y + height, true);
+        if (first == 0) drawLine(x - 1, field.y, x - 1, field.y + height, GRAPHICS_INVERSE);
+        for (uint8_t i = first; i < length; i++) {
+            int w = drawChar(x, field.y, bChars[i], mode);
+            if (w < 0) break;
+            if (w > 0) {
+                drawLine(x + w, field.y, x + w, field.y + height, GRAPHICS_INVERSE);
+                x += w + 1;
+            }
+        }
+    }
+
+    memcpy(field.text, bChars, length);
+    field.length = length;
+    selectFont(prevFont, prevOffsets);
+}
+
+// Renders the text once into marqueeStrip (1 bit per pixel, 1 = lit, row
+// major, bit 7 leftmost). Strip column 0 is the blank column drawString()
+// puts left of the text, every glyph is followed by one blank column.
 void DMD::drawMarquee(const char *bChars, uint8_t length, int left, int top) {
+    drawMarqueeFrom(bChars, false, length, left, top);
+}
+
+void DMD::drawMarquee_P(const char *bChars, uint8_t length, int left, int top) {
+    drawMarqueeFrom(bChars, true, length, left, top);
+}
+
+void DMD::drawMarqueeFrom(const char *bChars, bool progmem, uint8_t length, int left, int top) {
+    uint8_t height = pgm_read_byte(this->Font + FONT_HEIGHT);
+    uint8_t bytes = (height + 7) / 8;
+
     marqueeWidth = 0;
     for (int i = 0; i < length; i++) {
-        marqueeText[i] = bChars[i];
-        marqueeWidth += charWidth(bChars[i]) + 1;
+        int w = charWidth(dmdTextChar(bChars, progmem, i));
+        if (w > 0) marqueeWidth += w + 1;
     }
-    marqueeHeight = pgm_read_byte(this->Font + FONT_HEIGHT);
-    marqueeText[length] = '\0';
+    marqueeHeight = height;
+    marqueeRows = height + 1;   // gap columns span height + 1 rows
+    marqueeStride = (marqueeWidth + 1 + 7) / 8;
     marqueeOffsetY = top;
     marqueeOffsetX = left;
-    marqueeLength = length;
-    drawString(marqueeOffsetX, marqueeOffsetY, marqueeText, marqueeLength, GRAPHICS_NORMAL);
+    // The first steps blank the panel, as after a wrap: a back buffer swapped
+    // out before the marquee started still holds the previous screen
+    marqueeClears = bDoubleBuffered ? 2 : 1;
+    marqueeBandY[0] = marqueeBandY[1] = top;
+
+    uint16_t size = marqueeStride * marqueeRows;
+    uint8_t *strip = (uint8_t *) realloc(marqueeStrip, size);
+    if (strip == NULL) {
+        free(marqueeStrip);
+        marqueeStrip = NULL;
+        return;
+    }
+    marqueeStrip = strip;
+    memset(strip, 0, size);
+
+    uint8_t rows[32];
+    int x = 1;
+    for (int i = 0; i < length; i++) {
+        uint16_t index;
+        uint8_t width;
+        unsigned char c = dmdTextChar(bChars, progmem, i);
+        if (c == ' ') {
+            x += charWidth(' ') + 1;
+            continue;
+        }
+        if (!findGlyph(c, index, width) || height >= 32) continue;
+
+        for (uint8_t j0 = 0; j0 < width; j0 += 8) {
+            uint8_t w8 = width - j0;
+            if (w8 > 8) w8 = 8;
+            dmdGlyphRows(this->Font + index, width, bytes, height, j0, w8, rows);
+
+            uint8_t *p = strip + ((x + j0) >> 3);
+            uint8_t shift = (x + j0) & 7;
+            for (uint8_t r = 0; r <= dmdGlyphLastRow(bytes, height); r++) {
+                p[0] |= rows[r] >> shift;
+                if (shift && ((x + j0) >> 3) + 1 < marqueeStride) {
+                    p[1] |= rows[r] << (8 - shift);
+                }
+                p += marqueeStride;
+            }
+        }
+        x += width + 1;
+    }
+
+    drawMarqueeStrip();
+}
+
+// Copies the panel-wide window of the strip into the marquee's rows: a
+// byte-aligned shift per framebuffer byte, nothing is rasterized again.
+void DMD::drawMarqueeStrip() {
+    if (marqueeStrip == NULL) return;
+    int pixelsWide = DMD_PIXELS_ACROSS * DisplaysWide;
+    int pixelsHigh = DMD_PIXELS_DOWN * DisplaysHigh;
+
+    // Strip bit under screen x = 0
+    int s0 = 1 - marqueeOffsetX;
+    int firstIdx = (s0 >= 0) ? (s0 >> 3) : -((7 - s0) >> 3);
+    uint8_t shift = s0 & 7;
+
+    int yFirst = -1, yLast = -1;
+    for (uint8_t r = 0; r < marqueeRows; r++) {
+        int y = marqueeOffsetY + r;
+        if (y < 0 || y >= pixelsHigh) continue;
+        if (yFirst < 0) yFirst = y;
+        yLast = y;
+
+        const uint8_t *row = marqueeStrip + r * marqueeStride;
+        int idx = firstIdx;
+        uint8_t hi = (idx >= 0 && idx < marqueeStride) ? row[idx] : 0;
+        uint8_t *p = screenByte(0, y);
+        for (uint8_t n = pixelsWide >> 3; n; n--) {
+            idx++;
+            uint8_t lo = (idx >= 0 && idx < marqueeStride) ? row[idx] : 0;
+            uint8_t bits = (hi << shift) | (lo >> (8 - shift));
+            *p = ~bits;     // framebuffer: 0 = lit
+            p += DMD_RAM_STEP_X;
+            hi = lo;
+        }
+    }
+    if (yFirst >= 0) markDirty(0, yFirst, pixelsWide - 1, yLast);
+}
+
+void DMD::clearMarqueeTrail(int oldY) {
+    int pixelsWide = DMD_PIXELS_ACROSS * DisplaysWide;
+    if (oldY < marqueeOffsetY) {
+        int end = oldY + marqueeRows;
+        if (end > marqueeOffsetY) end = marqueeOffsetY;
+        clearRect(0, oldY, pixelsWide - 1, end - 1, true);
+    } else if (oldY > marqueeOffsetY) {
+        int start = marqueeOffsetY + marqueeRows;
+        if (start < oldY) start = oldY;
+        clearRect(0, start, pixelsWide - 1, oldY + marqueeRows - 1, true);
+    }
 }
 
 bool DMD::stepMarquee(int amountX, int amountY) {
@@ -243,27 +736,41 @@ bool DMD::stepMarquee(int amountX, int amountY) {
     marqueeOffsetY += amountY;
     if (marqueeOffsetX < -marqueeWidth) {
         marqueeOffsetX = DMD_PIXELS_ACROSS * DisplaysWide;
-        clearScreen(true);
         ret = true;
     } else if (marqueeOffsetX > DMD_PIXELS_ACROSS * DisplaysWide) {
         marqueeOffsetX = -marqueeWidth;
-        clearScreen(true);
         ret = true;
     }
     if (marqueeOffsetY < -marqueeHeight) {
         marqueeOffsetY = DMD_PIXELS_DOWN * DisplaysHigh;
-        clearScreen(true);
         ret = true;
     } else if (marqueeOffsetY > DMD_PIXELS_DOWN * DisplaysHigh) {
         marqueeOffsetY = -marqueeHeight;
-        clearScreen(true);
         ret = true;
     }
-    drawString(marqueeOffsetX, marqueeOffsetY, marqueeText, marqueeLength, GRAPHICS_NORMAL);
+
+    // A wrap blanks the panel, in both buffers when double-buffered
+    if (ret) marqueeClears = bDoubleBuffered ? 2 : 1;
+    if (marqueeClears) {
+        clearScreen(true);
+        marqueeClears--;
+    }
+
+    // Blank what earlier bands left outside the new one: the previous step,
+    // and in a double-buffered back buffer the step before that
+    clearMarqueeTrail(marqueeBandY[0]);
+    if (bDoubleBuffered) clearMarqueeTrail(marqueeBandY[1]);
+    marqueeBandY[1] = marqueeBandY[0];
+    marqueeBandY[0] = marqueeOffsetY;
+
+    drawMarqueeStrip();
     return ret;
 }
 
 void DMD::drawLine(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode) {
+    if (y1 == y2) { drawHLine(x1, x2, y1, bGraphicsMode); return; }
+    if (x1 == x2) { drawVLine(x1, y1, y2, bGraphicsMode); return; }
+
     int dy = y2 - y1;
     int dx = x2 - x1;
     int stepx, stepy;
@@ -295,9 +802,52 @@ void DMD::drawBox(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode) {
     drawLine(x1, y2, x1, y1, bGraphicsMode);
 }
 
+void DMD::drawHLine(int x1, int x2, int y, uint8_t bGraphicsMode) {
+    if (x1 > x2) { int t = x1; x1 = x2; x2 = t; }
+    fillRect(x1, y, x2, y, bGraphicsMode);
+}
+
+void DMD::drawVLine(int x, int y1, int y2, uint8_t bGraphicsMode) {
+    if (y1 > y2) { int t = y1; y1 = y2; y2 = t; }
+    fillRect(x, y1, x, y2, bGraphicsMode);
+}
+
 void DMD::drawFilledBox(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode) {
-    for (int b = x1; b <= x2; b++) {
-        drawLine(b, y1, b, y2, bGraphicsMode);
+    // Columns run x1..x2 only (nothing if x1 > x2), rows in either direction
+    if (y1 > y2) { int t = y1; y1 = y2; y2 = t; }
+    fillRect(x1, y1, x2, y2, bGraphicsMode);
+}
+
+// Sets every pixel of the inclusive rectangle (x1 <= x2, y1 <= y2) in the given
+// mode, a whole byte at a time with masks for the partial edge bytes.
+void DMD::fillRect(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode) {
+    int pixelsWide = DMD_PIXELS_ACROSS * DisplaysWide;
+    int pixelsHigh = DMD_PIXELS_DOWN * DisplaysHigh;
+
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= pixelsWide) x2 = pixelsWide - 1;
+    if (y2 >= pixelsHigh) y2 = pixelsHigh - 1;
+    if (x1 > x2 || y1 > y2) return;
+    markDirty(x1, y1, x2, y2);
+
+    DMDRasterOp op = dmdRasterOp(bGraphicsMode);
+    uint8_t firstMask = 0xFF >> (x1 & 7);
+    uint8_t lastMask = 0xFF << (7 - (x2 & 7));
+    uint8_t midBytes = (x2 >> 3) - (x1 >> 3);   // bytes after the first one
+    if (midBytes == 0) firstMask &= lastMask;
+
+    for (int y = y1; y <= y2; y++) {
+        uint8_t *p = screenByte(x1, y);
+        *p = dmdBlend(*p, firstMask, firstMask, op);
+        if (midBytes) {
+            for (uint8_t n = midBytes - 1; n; n--) {
+                p += DMD_RAM_STEP_X;
+                *p = dmdBlend(*p, 0xFF, 0xFF, op);
+            }
+            p += DMD_RAM_STEP_X;
+            *p = dmdBlend(*p, lastMask, lastMask, op);
+        }
     }
 }
 
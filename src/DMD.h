@@ -67,6 +67,64 @@
 #define DMD_BITSPERPIXEL           1      
 #define DMD_RAM_SIZE_BYTES        ((DMD_PIXELS_ACROSS*DMD_BITSPERPIXEL/8)*DMD_PIXELS_DOWN)
 
+// Compile-time geometry: define DMD_PANELS_WIDE and DMD_PANELS_HIGH (e.g. in
+// platformio.ini build_flags) to fix the panel layout at build time. Geometry
+// members become constants, so panel math folds into shifts and the scan loop
+// gets a fixed trip count, and the frame and back buffer live in .bss instead
+// of the heap. Panel counts passed to the constructor are then ignored.
+// DMD_SINGLE_PANEL is the RAM-budget shorthand for a 1x1 layout. The static
+// back buffer is only reserved with DMD_DOUBLE_BUFFERED; without it a
+// constructor asking for double buffering falls back to a single buffer.
+#ifdef DMD_SINGLE_PANEL
+#define DMD_PANELS_WIDE           1
+#define DMD_PANELS_HIGH           1
+#endif
+
+#if defined(DMD_PANELS_WIDE) && defined(DMD_PANELS_HIGH)
+#define DMD_FIXED_GEOMETRY        1
+#define DMD_STATIC_BUFFER_BYTES   (DMD_RAM_SIZE_BYTES * DMD_PANELS_WIDE * DMD_PANELS_HIGH)
+#ifndef DMD_STATIC_BUFFERS
+#ifdef DMD_DOUBLE_BUFFERED
+#define DMD_STATIC_BUFFERS        2
+#else
+#define DMD_STATIC_BUFFERS        1
+#endif
+#endif
+#if DMD_STATIC_BUFFERS != 1 && DMD_STATIC_BUFFERS != 2
+#error "DMD_STATIC_BUFFERS must be 1 or 2"
+#endif
+#else
+#define DMD_FIXED_GEOMETRY        0
+#endif
+
+// Scan budget. A row is 16 bytes per panel, sent as a polled burst at fck/2
+// from the Timer1 ISR at ~22 CPU cycles per byte (16 on the wire). Once
+// every 2 ms scan period (32000 cycles) that costs, estimated from the
+// instruction count of the loop (not measured):
+//   panels   per row (Timer1 ISR)
+//     1        352 cyc   22 us
+//     2        704 cyc   44 us
+//     4       1408 cyc   88 us
+// An SPI transfer-complete interrupt per byte would cost more than the byte
+// itself (entry/exit alone exceeds 16 cycles), so the burst stays polled.
+// scanStats() measures the row time with TCNT1 on the real chain; main.cpp
+// prints it at boot. Nothing adapts to it: OCR1A also paces system_ticks.
+#define DMD_SCAN_TICK_CYCLES      64      // Timer1 prescaler: cycles per TCNT1 tick
+
+struct DMDScanStats {
+    uint8_t panels;
+    uint16_t bytesPerRow;
+    uint16_t rowCyclesMax;      // measured, first byte to latch (TCNT1 resolution)
+};
+
+// Framebuffer layout: with DMD_SCAN_ORDER_RAM set, bDMDScreenRAM holds each of
+// the 4 scan phases as one contiguous run in shift-out order, so a row is sent
+// with a single post-incremented pointer. writePixel() does the address
+// translation instead (see ramIndex()). Set it to 0 for the row-major layout.
+#ifndef DMD_SCAN_ORDER_RAM
+#define DMD_SCAN_ORDER_RAM        1
+#endif
+
 // Lookup table for pixel bitmask (Stored in header for static access or move to cpp)
 static const uint8_t bPixelLookupTable[8] = {
    0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
@@ -80,54 +138,120 @@ static const uint8_t bPixelLookupTable[8] = {
 #define FONT_CHAR_COUNT         5
 #define FONT_WIDTH_TABLE        6
 
+// Retained text label for DMD::updateTextField(): remembers what is on screen
+// so an update only redraws the glyphs whose character changed.
+#define DMD_TEXT_FIELD_MAX      8
+
+struct DMDTextField {
+    int x, y;
+    uint8_t graphicsMode;
+    uint8_t length;
+    const uint8_t* font;
+    const uint16_t* fontOffsets;
+    char text[DMD_TEXT_FIELD_MAX];
+};
+
 class DMD {
   public:
-    DMD(uint8_t panelsWide, uint8_t panelsHigh);
+    // doubleBuffered: draw into an off-screen back buffer and publish it with swapBuffers()
+    DMD(uint8_t panelsWide, uint8_t panelsHigh, bool doubleBuffered = false);
     
     // Core Graphics
     void writePixel(unsigned int bX, unsigned int bY, uint8_t bGraphicsMode, uint8_t bPixel);
     void drawString(int bX, int bY, const char* bChars, uint8_t length, uint8_t bGraphicsMode);
-    void selectFont(const uint8_t* font);
+    void drawString_P(int bX, int bY, const char* bChars, uint8_t length, uint8_t bGraphicsMode); // PROGMEM text
+    // glyphOffsets: optional PROGMEM table of each glyph's byte index in a
+    // variable-width font (see Arial_Black_16_offsets); NULL sums the widths
+    void selectFont(const uint8_t* font, const uint16_t* glyphOffsets = NULL);
     int  drawChar(const int bX, const int bY, const unsigned char letter, uint8_t bGraphicsMode);
     int  charWidth(const unsigned char letter);
+
+    // Retained Text (uses the font selected at beginTextField time)
+    void beginTextField(DMDTextField &field, int bX, int bY, uint8_t bGraphicsMode);
+    void updateTextField(DMDTextField &field, const char* bChars, uint8_t length);
     
     // Marquee / Scrolling
     void drawMarquee(const char* bChars, uint8_t length, int left, int top);
+    void drawMarquee_P(const char* bChars, uint8_t length, int left, int top);   // PROGMEM text
     bool stepMarquee(int amountX, int amountY); // bool is standard in C++ (or include stdbool.h for C)
 
     // Shapes & Helpers
     void clearScreen(uint8_t bNormal);
+    void clearRect(int x1, int y1, int x2, int y2, uint8_t bNormal); // like clearScreen, region only
     void drawLine(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode);
+    void drawHLine(int x1, int x2, int y, uint8_t bGraphicsMode);
+    void drawVLine(int x, int y1, int y2, uint8_t bGraphicsMode);
     void drawCircle(int xCenter, int yCenter, int radius, uint8_t bGraphicsMode);
     void drawBox(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode);
     void drawFilledBox(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode);
     void drawTestPattern(uint8_t bPattern);
 
+    // Double Buffering
+    // Waits until the scan ISR shows the back buffer (next row-0 boundary).
+    // keepContent copies what was drawn since the last swap into the new back
+    // buffer, so the next frame can be drawn incrementally.
+    void swapBuffers(bool keepContent = false);
+
     // Hardware Driver
     void scanDisplayBySPI();
+    void scanStats(DMDScanStats &stats);
 
   private:
     void drawCircleSub(int cx, int cy, int x, int y, uint8_t bGraphicsMode);
     void spi_init_bare();
     inline void spi_transfer_bare(uint8_t data);
+    inline void latchRow();
+    inline unsigned int ramIndex(unsigned int bX, unsigned int bY);
+    inline uint8_t *screenByte(unsigned int x, unsigned int y);
+    inline void markDirty(int x1, int y1, int x2, int y2);
+    void fillRect(int x1, int y1, int x2, int y2, uint8_t bGraphicsMode);
+    bool findGlyph(unsigned char c, uint16_t &index, uint8_t &width);
+    void drawStringFrom(int bX, int bY, const char* bChars, bool progmem, uint8_t length, uint8_t bGraphicsMode);
+    void drawMarqueeFrom(const char* bChars, bool progmem, uint8_t length, int left, int top);
+    void drawMarqueeStrip();
+    void clearMarqueeTrail(int oldY);
+    void blitGlyph(int bX, int bY, uint16_t index, uint8_t width, uint8_t bytes, uint8_t height, uint8_t bGraphicsMode);
+
+    uint8_t *bDMDScreenRAM;             // draw target (back buffer when double-buffered)
+    uint8_t *bDMDScanRAM;               // buffer shifted out by scanDisplayBySPI
+    bool bDoubleBuffered;
+    volatile bool bSwapPending;
 
-    uint8_t *bDMDScreenRAM;
+    // Bounding box (pixels) drawn since the last swap, empty when x1 > x2
+    int dirtyX1, dirtyY1, dirtyX2, dirtyY2;
 
-    char marqueeText[256];
-    uint8_t marqueeLength;
+    uint8_t *marqueeStrip;      // pre-rendered text, sized to fit (heap)
+    uint16_t marqueeStride;     // bytes per strip row
+    uint8_t marqueeRows;
+    uint8_t marqueeClears;      // buffers still to blank after a wrap
+    int marqueeBandY[2];        // marqueeOffsetY of the last two steps
     int marqueeWidth;
     int marqueeHeight;
     int marqueeOffsetX;
     int marqueeOffsetY;
 
     const uint8_t* Font;
+    const uint16_t* FontOffsets;
 
+#if DMD_FIXED_GEOMETRY
+    static const uint8_t DisplaysWide = DMD_PANELS_WIDE;
+    static const uint8_t DisplaysHigh = DMD_PANELS_HIGH;
+    static const uint8_t DisplaysTotal = DMD_PANELS_WIDE * DMD_PANELS_HIGH;
+    static const int row1 = DisplaysTotal << 4;
+    static const int row2 = DisplaysTotal << 5;
+    static const int row3 = ((DisplaysTotal << 2) * 3) << 2;
+#else
     uint8_t DisplaysWide;
     uint8_t DisplaysHigh;
     uint8_t DisplaysTotal;
     int row1, row2, row3;
+#endif
 
     volatile uint8_t bDMDByte;
+
+    // Scan timing (TCNT1 ticks)
+    uint16_t scanStartTicks;
+    volatile uint16_t scanTicksMax;
 };
 
 #endif /* DMD_AVR_H_ */
@@ -0,0 +1,281 @@
+#include <avr/io.h>
+#include <util/delay.h>
+#include <avr/interrupt.h>
+#include <stdint.h>
+#include "HX711.h"
+#include "init.h"
+
+extern volatile unsigned long system_ticks;
+
+static HX711 *hx711Active;
+
+// All converters have a conversion waiting
+static inline bool hx711_ready(void) {
+#if HX711_CHANNELS > 1
+    if (PINB & (1 << HX_DOUT2)) return false;
+#endif
+    return !(PIND & (1 << HX_DOUT));
+}
+
+// One SCK pulse. SCK held high for more than 60 us powers the HX711
+// down, so in bit mode only the high phase is protected. The fast
+// variant keeps both phases near the 0.2 us datasheet minimum
+static inline void hx711_clock(bool fast) {
+#if HX711_READ_MODE == HX711_READ_BIT
+    uint8_t oldSREG = SREG;
+    cli();
+#endif
+    PORTD |= (1 << HX_SCK);
+    if (fast) _delay_us(0.25); else _delay_us(1);
+    PORTD &= ~(1 << HX_SCK);
+#if HX711_READ_MODE == HX711_READ_BIT
+    SREG = oldSREG;
+#endif
+    if (fast) _delay_us(0.25); else _delay_us(1);
+}
+
+HX711::HX711(uint8_t gain)
+{
+    head = tail = 0;
+    overrun = 0;
+    async = false;
+    gainPulses = gain;
+    settle = 0;
+    fastClock = false;
+    lastCycles = 0;
+    interval = 0;
+}
+
+void HX711::begin()
+{
+    // DOUT as input
+    DDRD &= ~(1 << HX_DOUT);
+#if HX711_CHANNELS > 1
+    DDRB &= ~(1 << HX_DOUT2);
+#endif
+
+    // SCK as output
+    DDRD |= (1 << HX_SCK);
+    PORTD &= ~(1 << HX_SCK);   // Start low
+
+    // The chip powers up on channel A at gain 128, so the first conversion
+    // read is at the wrong gain unless that is the one selected
+    uint8_t oldSREG = SREG;
+    cli();
+    settle = (gainPulses != HX711_GAIN_128);
+    SREG = oldSREG;
+}
+
+void HX711::setGain(uint8_t gain)
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    if (gain != gainPulses) {
+        gainPulses = gain;
+        settle = 1;
+    }
+    SREG = oldSREG;
+}
+
+// Clock out one conversion from every channel at once; all DOUTs must
+// already be low. Each edge costs one port read per channel port
+void HX711::shiftIn(long *values)
+{
+    long v0 = 0;
+#if HX711_CHANNELS > 1
+    long v1 = 0;
+#endif
+    bool fast = fastClock;
+
+#if HX711_READ_MODE == HX711_READ_WORD
+    uint8_t oldSREG = SREG;
+    cli(); // Disable interrupts during the 24-bit read
+#endif
+
+    for (uint8_t i = 0; i < 24; i++) {
+        hx711_clock(fast);
+        uint8_t pd = PIND;
+#if HX711_CHANNELS > 1
+        uint8_t pb = PINB;
+        v1 = v1 << 1;
+        if (pb & (1 << HX_DOUT2)) {
+            v1++;
+        }
+#endif
+        v0 = v0 << 1;
+        if (pd & (1 << HX_DOUT)) {
+            v0++;
+        }
+    }
+
+    // Trailing pulses select gain/channel for the next conversion
+    for (uint8_t i = 0; i < gainPulses; i++) {
+        hx711_clock(fast);
+    }
+
+#if HX711_READ_MODE == HX711_READ_WORD
+    SREG = oldSREG; // Re-enable interrupts
+#endif
+
+    if (v0 & 0x800000) v0 |= 0xFF000000; // Sign extend
+    values[0] = v0;
+#if HX711_CHANNELS > 1
+    if (v1 & 0x800000) v1 |= 0xFF000000;
+    values[1] = v1;
+#endif
+}
+
+void HX711::read(long *values)
+{
+    if (async) {
+        hx711_sample_t sample;
+        while (!pop(sample)); // Wait for the ISR to queue one
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) values[ch] = sample.value[ch];
+        return;
+    }
+
+    for (;;) {
+        while (!hx711_ready()); // Wait for ready
+        shiftIn(values);
+        if (!settle) return;
+        settle--; // converted at the previous gain
+    }
+}
+
+// Producer side, never re-entered (pin-change interrupts are off while
+// it runs from the ISR)
+void HX711::service()
+{
+    // Our own SCK pulses toggle DOUT and re-arm the pin-change flag, so
+    // drain by level rather than by edge and clear the flag afterwards
+    while (hx711_ready()) {
+        uint8_t oldSREG = SREG;
+        cli();
+        unsigned long ticks = system_ticks;
+        SREG = oldSREG;
+        uint32_t now = sys_cycles();
+
+        long values[HX711_CHANNELS];
+        shiftIn(values);
+
+        // Conversion interval in us, averaged over ~8 conversions
+        if (lastCycles) {
+            uint32_t dt = (now - lastCycles) / (F_CPU / 1000000UL);
+            if (interval) interval += ((int32_t)dt - (int32_t)interval) >> 3;
+            else interval = dt;
+            fastClock = interval < HX711_FAST_INTERVAL_US;
+        }
+        lastCycles = now;
+
+        uint8_t next = (head + 1) & (HX711_RING_SIZE - 1);
+        if (settle) {
+            settle--; // converted at the previous gain
+        } else if (next == tail) {
+            overrun++; // consumer fell behind, drop the newest
+        } else {
+            for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) ring[head].value[ch] = values[ch];
+            ring[head].ticks = ticks;
+            head = next;
+        }
+        PCIFR = (1 << PCIF2) | (1 << PCIF0);
+    }
+}
+
+void HX711::dataReady()
+{
+#if HX711_READ_MODE == HX711_READ_BIT
+    // Let the display timer preempt the read; mask ourselves meanwhile.
+    // service() leaves the flag set if a DOUT fell again after it looked
+    uint8_t mask = PCICR;
+    PCICR = mask & ~((1 << PCIE2) | (1 << PCIE0));
+    sei();
+    service();
+    cli();
+    PCICR = mask;
+#else
+    service();
+#endif
+}
+
+ISR(PCINT2_vect)
+{
+    hx711Active->dataReady();
+}
+
+#if HX711_CHANNELS > 1
+// Second DOUT; whichever converter finishes last triggers the read
+ISR(PCINT0_vect)
+{
+    hx711Active->dataReady();
+}
+#endif
+
+void HX711::start()
+{
+    uint8_t oldSREG = SREG;
+    cli();
+
+    hx711Active = this;
+    head = tail = 0;
+    overrun = 0;
+    async = true;
+
+    PCMSK2 |= (1 << PCINT21);  // PD5 = HX_DOUT
+    PCIFR = (1 << PCIF2);
+    PCICR |= (1 << PCIE2);
+#if HX711_CHANNELS > 1
+    PCMSK0 |= (1 << PCINT4);   // PB4 = HX_DOUT2
+    PCIFR = (1 << PCIF0);
+    PCICR |= (1 << PCIE0);
+#endif
+
+    // A conversion that is already waiting will not produce an edge
+    service();
+
+    SREG = oldSREG;
+}
+
+uint8_t HX711::available()
+{
+    return (head - tail) & (HX711_RING_SIZE - 1);
+}
+
+bool HX711::pop(hx711_sample_t &sample)
+{
+    uint8_t t = tail;
+    if (t == head) return false;
+
+    // 32-bit fields: the ISR won't touch this slot until tail moves on
+    sample = ring[t];
+    tail = (t + 1) & (HX711_RING_SIZE - 1);
+    return true;
+}
+
+void HX711::flush()
+{
+    tail = head;
+}
+
+uint16_t HX711::overruns()
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t n = overrun;
+    SREG = oldSREG;
+    return n;
+}
+
+uint32_t HX711::intervalUs()
+{
+    uint8_t oldSREG = SREG;
+    cli();
+    uint32_t us = interval;
+    SREG = oldSREG;
+    return us;
+}
+
+uint8_t HX711::sampleRate()
+{
+    uint32_t us = intervalUs();
+    return us ? (uint8_t)((1000000UL + us / 2) / us) : 0;
+}
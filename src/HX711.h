@@ -0,0 +1,88 @@
+#ifndef HX711_H
+#define HX711_H
+
+#include <stdint.h>
+
+// Loadcell
+#define HX_DOUT PD5   // Digital input
+#define HX_SCK  PD4   // Digital output, shared by every channel
+
+// Load cells clocked together on HX_SCK (1 or 2). PORTD has no pin left,
+// so the second DOUT is PB4 (MISO, an input while SPI is master)
+#ifndef HX711_CHANNELS
+#define HX711_CHANNELS 1
+#endif
+#define HX_DOUT2 PB4
+
+// Gain/channel, as the number of extra SCK pulses after the 24 data bits.
+// Applies from the conversion after the one being read
+#define HX711_GAIN_128 1    // Channel A, 25 pulses
+#define HX711_GAIN_32  2    // Channel B, 26 pulses
+#define HX711_GAIN_64  3    // Channel A, 27 pulses
+
+// HX711_READ_WORD: interrupts off for the whole 27-pulse read (~60 us)
+// HX711_READ_BIT:  interrupts off only while SCK is high (~1.5 us)
+#define HX711_READ_WORD 0
+#define HX711_READ_BIT  1
+#ifndef HX711_READ_MODE
+#define HX711_READ_MODE HX711_READ_BIT
+#endif
+
+// Sample ring filled from PCINT2 (HX711 DOUT falling edge), power of 2
+#ifndef HX711_RING_SIZE
+#define HX711_RING_SIZE 8
+#endif
+
+// Conversion interval below which the board is taken as strapped for 80 SPS
+#define HX711_FAST_INTERVAL_US 25000
+
+typedef struct {
+    long value[HX711_CHANNELS]; // sign-extended 24-bit conversions
+    unsigned long ticks;    // system_ticks when it was clocked out
+} hx711_sample_t;
+
+class HX711 {
+public:
+    HX711(uint8_t gain = HX711_GAIN_64);
+
+    void begin();
+    void setGain(uint8_t gain);
+    uint8_t gain() const { return gainPulses; }
+
+    // Blocking read of every channel, only until start()
+    void read(long *values);
+
+    // Asynchronous acquisition: single producer (ISR), single consumer (main)
+    void start();
+    uint8_t available();
+    bool pop(hx711_sample_t &sample);
+    void flush();
+    uint16_t overruns();
+
+    // Measured conversion interval (0 until two conversions were seen)
+    uint32_t intervalUs();
+    uint8_t sampleRate();
+    bool fastRate() { return fastClock; }
+
+    // Pin-change interrupt hook
+    void dataReady();
+
+private:
+    void shiftIn(long *values);
+    void service();
+
+    hx711_sample_t ring[HX711_RING_SIZE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile uint16_t overrun;
+    bool async;
+
+    uint8_t gainPulses;
+    uint8_t settle;         // conversions left at the previous gain
+    bool fastClock;         // 80 SPS: SCK pulses at datasheet minimum
+
+    uint32_t lastCycles;
+    volatile uint32_t interval;
+};
+
+#endif
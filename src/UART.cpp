@@ -3,36 +3,250 @@
 #include <avr/interrupt.h> 
 #include <stdint.h> 
 #include <stdlib.h>
+#include <avr/pgmspace.h>
+#include "UART.h"
 
 // --- Definitions ---
+#ifndef F_CPU
 #define F_CPU 16000000UL
-#define USART_BAUDRATE 9600
-#define BAUD_PRESCALER (((F_CPU / (USART_BAUDRATE * 16UL))) - 1)
+#endif
+
+// Rounded UBRR for a clock divider of 16 (normal) or 8 (U2X)
+static constexpr uint16_t usart_ubrr(uint32_t baud, uint8_t div) {
+  return (F_CPU + (uint32_t)div * baud / 2) / ((uint32_t)div * baud) - 1;
+}
+
+// Resulting rate error in 0.1 % steps
+static constexpr int16_t usart_error(uint32_t baud, uint8_t div) {
+  return (int16_t)(((int32_t)(F_CPU / ((uint32_t)div * (usart_ubrr(baud, div) + 1UL))) - (int32_t)baud)
+                   * 1000L / (int32_t)baud);
+}
+
+static constexpr int16_t usart_abs(int16_t v) {
+  return v < 0 ? -v : v;
+}
+
+// Double speed halves the receiver's oversampling, so only when it is closer
+static constexpr bool usart_u2x(uint32_t baud) {
+  return usart_abs(usart_error(baud, 8)) < usart_abs(usart_error(baud, 16));
+}
+
+#define USART_DIV(baud) (usart_u2x(baud) ? 8 : 16)
+#define USART_BAUD_ENTRY(baud) \
+  { baud, usart_ubrr(baud, USART_DIV(baud)), usart_u2x(baud), (int8_t)usart_error(baud, USART_DIV(baud)) }
+
+static_assert(usart_abs(usart_error(USART_BAUDRATE, USART_DIV(USART_BAUDRATE))) <= USART_MAX_ERROR,
+              "USART_BAUDRATE is too far off at this F_CPU");
+
+// Rates selectable at run time, worked out by the compiler
+static const usart_baud_t usartBauds[] PROGMEM = {
+  USART_BAUD_ENTRY(9600),
+  USART_BAUD_ENTRY(19200),
+  USART_BAUD_ENTRY(38400),
+  USART_BAUD_ENTRY(57600),
+  USART_BAUD_ENTRY(115200),
+  USART_BAUD_ENTRY(230400),
+  USART_BAUD_ENTRY(250000),
+  USART_BAUD_ENTRY(500000),
+  USART_BAUD_ENTRY(1000000),
+};
+
+static uint32_t usartBaud = USART_BAUDRATE;
+
+// TX ring: main is the only producer, the UDRE interrupt the only consumer
+static uint8_t txBuf[USART_TX_SIZE];
+static volatile uint8_t txHead = 0;
+static volatile uint8_t txTail = 0;
+static volatile uint16_t txDropped = 0;
+static uint8_t txPolicy = USART_TX_POLICY;
+
+// RX ring: the RX interrupt produces, main consumes
+static uint8_t rxBuf[USART_RX_SIZE];
+static volatile uint8_t rxHead = 0;
+static volatile uint8_t rxTail = 0;
+static volatile uint16_t rxDropped = 0;
 
 // =======================================================
 // =================== UART FUNCTIONS  ===================
 // =======================================================
 
 void USART_Init() {
-  UBRR0H = BAUD_PRESCALER >> 8;
-  UBRR0L = BAUD_PRESCALER;
-  UCSR0A = 0x00;
+  constexpr uint16_t ubrr = usart_ubrr(USART_BAUDRATE, USART_DIV(USART_BAUDRATE));
+  UBRR0H = ubrr >> 8;
+  UBRR0L = ubrr;
+  UCSR0A = usart_u2x(USART_BAUDRATE) ? (1<<U2X0) : 0x00;
   UCSR0C = (1<<UCSZ01) | (1<<UCSZ00); 
-  UCSR0B = (1<<RXEN0) | (1<<TXEN0);
+  UCSR0B = (1<<RXEN0) | (1<<TXEN0) | (1<<RXCIE0);
 }
 
+// Bypasses the TX ring
 void USART_TransmitPolling(uint8_t DataByte) {
   while (( UCSR0A & (1<<UDRE0)) == 0) {};
   UDR0 = DataByte;
 }
 
+ISR(USART_UDRE_vect) {
+  uint8_t tail = txTail;
+  if (tail == txHead) {
+    UCSR0B &= ~(1<<UDRIE0); // Ring empty, stop until the next print
+    return;
+  }
+  UDR0 = txBuf[tail];
+  txTail = (tail + 1) & (USART_TX_SIZE - 1);
+}
+
+// Queue one byte; the hot path cost is a store and an index update
+void USART_Transmit(uint8_t DataByte) {
+  uint8_t next = (txHead + 1) & (USART_TX_SIZE - 1);
+
+  while (next == txTail) {
+    if (txPolicy == USART_TX_DROP_NEWEST) {
+      txDropped++;
+      return;
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    if (txPolicy == USART_TX_DROP_OLDEST) {
+      if (next == txTail) {
+        txTail = (txTail + 1) & (USART_TX_SIZE - 1);
+        txDropped++;
+      }
+    } else if (!(oldSREG & (1<<SREG_I))) {
+      // Blocking with interrupts off: nobody else will drain it
+      USART_TransmitPolling(txBuf[txTail]);
+      txTail = (txTail + 1) & (USART_TX_SIZE - 1);
+    }
+    SREG = oldSREG;
+  }
+
+  txBuf[txHead] = DataByte;
+  txHead = next;
+  UCSR0B |= (1<<UDRIE0);
+}
+
+uint8_t USART_SetTxPolicy(uint8_t policy) {
+  uint8_t old = txPolicy;
+  txPolicy = policy;
+  return old;
+}
+
+uint16_t USART_TxDropped(void) {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t n = txDropped;
+  SREG = oldSREG;
+  return n;
+}
+
+uint8_t USART_TxFree(void) {
+  return (txTail - txHead - 1) & (USART_TX_SIZE - 1);
+}
+
+// Wait until everything queued has been handed to the UART
+void USART_Flush(void) {
+  while (txHead != txTail) {
+    if (!(SREG & (1<<SREG_I))) {
+      USART_TransmitPolling(txBuf[txTail]);
+      txTail = (txTail + 1) & (USART_TX_SIZE - 1);
+    }
+  }
+}
+
+uint8_t USART_BaudCount(void) {
+  return sizeof(usartBauds) / sizeof(usartBauds[0]);
+}
+
+usart_baud_t USART_BaudEntry(uint8_t i) {
+  usart_baud_t entry;
+  memcpy_P(&entry, &usartBauds[i], sizeof(entry));
+  return entry;
+}
+
+uint32_t USART_Baud(void) {
+  return usartBaud;
+}
+
+// Table rates within USART_MAX_ERROR only
+static bool usart_find_baud(uint32_t baud, usart_baud_t *entry) {
+  for (uint8_t i = 0; i < USART_BaudCount(); i++) {
+    *entry = USART_BaudEntry(i);
+    if (entry->baud == baud) return usart_abs(entry->error) <= USART_MAX_ERROR;
+  }
+  return false;
+}
+
+bool USART_BaudSupported(uint32_t baud) {
+  usart_baud_t entry;
+  return usart_find_baud(baud, &entry);
+}
+
+// Everything queued goes out at the old rate first
+bool USART_SetBaud(uint32_t baud) {
+  usart_baud_t entry;
+  if (!usart_find_baud(baud, &entry)) return false;
+
+  USART_Flush();
+  while ((UCSR0A & (1<<UDRE0)) == 0) {};
+  for (uint16_t n = 1000000UL / usartBaud + 1; n; n--) _delay_us(10); // last frame
+
+  uint8_t oldSREG = SREG;
+  cli();
+  UBRR0H = entry.ubrr >> 8;
+  UBRR0L = entry.ubrr;
+  UCSR0A = entry.u2x ? (1<<U2X0) : 0x00;
+  usartBaud = baud;
+  SREG = oldSREG;
+  return true;
+}
+
+ISR(USART_RX_vect) {
+  uint8_t status = UCSR0A; // flags belong to the byte in UDR0, read first
+  uint8_t data = UDR0;
+  if (status & ((1<<FE0) | (1<<DOR0))) {
+    rxDropped++; // garbled, or one lost before it (e.g. wrong baud rate)
+    return;
+  }
+  uint8_t next = (rxHead + 1) & (USART_RX_SIZE - 1);
+  if (next == rxTail) {
+    rxDropped++; // main loop fell behind
+    return;
+  }
+  rxBuf[rxHead] = data;
+  rxHead = next;
+}
+
+// Non-blocking: false when nothing has arrived
+bool USART_Receive(uint8_t *DataByte) {
+  uint8_t tail = rxTail;
+  if (tail == rxHead) return false;
+  *DataByte = rxBuf[tail];
+  rxTail = (tail + 1) & (USART_RX_SIZE - 1);
+  return true;
+}
+
+uint16_t USART_RxDropped(void) {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t n = rxDropped;
+  SREG = oldSREG;
+  return n;
+}
+
 void USART_PrintString(const char* str) {
     while (*str) {
-        USART_TransmitPolling(*str);
+        USART_Transmit(*str);
         str++;
     }
 }
 
+void USART_PrintString_P(const char* str) {
+    char c;
+    while ((c = pgm_read_byte(str++))) {
+        USART_Transmit(c);
+    }
+}
+
 void USART_PrintNumber(uint32_t num) {
     char buffer[11]; 
     ltoa(num, buffer, 10); 
@@ -1,8 +1,62 @@
-#ifndef INIT_H
-#define INIT_H
+#ifndef UART_H
+#define UART_H
 
-void Hardware_Init(void);
-void hx711_init(void);
-long hx711_read(void);
+#include <stdint.h>
 
-#endif
\ No newline at end of file
+// Boot rate; platformio.ini passes monitor_speed so both always agree
+#ifndef USART_BAUDRATE
+#define USART_BAUDRATE 115200
+#endif
+
+// Largest rate error accepted, 0.1 % steps. 115200 from 16 MHz is 2.1 %
+#ifndef USART_MAX_ERROR
+#define USART_MAX_ERROR 25
+#endif
+
+typedef struct {
+  uint32_t baud;
+  uint16_t ubrr;
+  uint8_t u2x;
+  int8_t error;           // 0.1 % steps
+} usart_baud_t;
+
+// TX ring drained by USART_UDRE_vect, power of 2
+#ifndef USART_TX_SIZE
+#define USART_TX_SIZE 64
+#endif
+
+// RX ring filled by USART_RX_vect, power of 2 up to 256. The main loop
+// reads it between frames, so it must hold what arrives during the longest
+// swapBuffers() wait (8 ms): 92 bytes at 115200. Above that rate a line
+// typed during a swap can overrun; USART_RxDropped() counts it
+#ifndef USART_RX_SIZE
+#define USART_RX_SIZE 128
+#endif
+
+// What a print does when the TX ring is full
+#define USART_TX_DROP_NEWEST 0  // discard the byte being printed
+#define USART_TX_DROP_OLDEST 1  // discard the oldest queued byte
+#define USART_TX_BLOCK       2  // wait for room (polls if interrupts are off)
+#ifndef USART_TX_POLICY
+#define USART_TX_POLICY USART_TX_BLOCK
+#endif
+
+void USART_Init(void);
+void USART_TransmitPolling(uint8_t DataByte);
+void USART_Transmit(uint8_t DataByte);
+uint8_t USART_SetTxPolicy(uint8_t policy);     // returns the previous one
+uint16_t USART_TxDropped(void);
+uint8_t USART_TxFree(void);
+void USART_Flush(void);
+bool USART_Receive(uint8_t *DataByte);
+uint16_t USART_RxDropped(void);
+uint8_t USART_BaudCount(void);
+usart_baud_t USART_BaudEntry(uint8_t i);
+bool USART_BaudSupported(uint32_t baud);
+bool USART_SetBaud(uint32_t baud);
+uint32_t USART_Baud(void);
+void USART_PrintString(const char* str);
+void USART_PrintString_P(const char* str);    // PROGMEM, e.g. PSTR("...")
+void USART_PrintNumber(uint32_t num);
+
+#endif
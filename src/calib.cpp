@@ -0,0 +1,117 @@
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "calib.h"
+
+// Built-in curve: same scale as the old score * 100 / 799999, but with
+// the 8,000,000 clamp landing on 999 instead of 1000
+static const calib_point_t calib_default[] PROGMEM = {
+    {       0L,   0 },
+    { 8000000L, 999 },
+};
+
+#define CALIB_MAGIC 0xCA
+
+// Twice the HX711's 24-bit span: room for any deviation, and differences
+// between points can't overflow
+#define CALIB_RAW_LIMIT 0x1000000L
+
+typedef struct {
+    uint8_t magic;
+    uint8_t count;
+    calib_point_t points[CALIB_MAX_POINTS];
+    uint8_t crc;
+} calib_store_t;
+
+static calib_store_t calibStore EEMEM;
+
+static calib_point_t curve[CALIB_MAX_POINTS];
+static long slope[CALIB_MAX_POINTS - 1];   // score per 256 raw counts, Q16
+static uint8_t curveLen;
+
+static uint8_t calib_crc(const calib_store_t *s) {
+    const uint8_t *p = (const uint8_t *)s;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < offsetof(calib_store_t, crc); i++) {
+        crc = _crc8_ccitt_update(crc, p[i]);
+    }
+    return crc;
+}
+
+// The only divides: one per segment, when a curve is loaded
+bool calib_load(const calib_point_t *points, uint8_t n) {
+    if (n < 2 || n > CALIB_MAX_POINTS) return false;
+    for (uint8_t i = 0; i < n; i++) {
+        if (points[i].raw > CALIB_RAW_LIMIT || points[i].raw < -CALIB_RAW_LIMIT) return false;
+    }
+    for (uint8_t i = 1; i < n; i++) {
+        // A closer pair would be a step, not a slope, at 256-count resolution
+        if (points[i].raw - points[i - 1].raw < CALIB_MIN_SPAN) return false;
+        // Keeps dy * 65536 inside 32 bits
+        long dy = (long)points[i].score - points[i - 1].score;
+        if (dy > 32767 || dy < -32767) return false;
+    }
+
+    memcpy(curve, points, n * sizeof(calib_point_t));
+    curveLen = n;
+
+    // calib_score() only interpolates for x0 <= raw < x1, where
+    // (raw - x0) >> 8 times this stays within dy * 65536, so it fits 32 bits
+    for (uint8_t i = 0; i + 1 < n; i++) {
+        long dx = (curve[i + 1].raw - curve[i].raw) >> 8;
+        slope[i] = (long)(curve[i + 1].score - curve[i].score) * 65536L / dx;
+    }
+    return true;
+}
+
+void calib_reset(void) {
+    calib_point_t points[sizeof(calib_default) / sizeof(calib_default[0])];
+    memcpy_P(points, calib_default, sizeof(calib_default));
+    calib_load(points, sizeof(calib_default) / sizeof(calib_default[0]));
+    eeprom_update_byte(&calibStore.magic, 0xFF);
+}
+
+void calib_init(void) {
+    calib_store_t s;
+    eeprom_read_block(&s, &calibStore, sizeof(s));
+
+    if (s.magic == CALIB_MAGIC && s.crc == calib_crc(&s) && calib_load(s.points, s.count)) {
+        return;
+    }
+    calib_reset();
+}
+
+void calib_save(void) {
+    calib_store_t s;
+    memset(&s, 0xFF, sizeof(s));
+    s.magic = CALIB_MAGIC;
+    s.count = curveLen;
+    memcpy(s.points, curve, curveLen * sizeof(calib_point_t));
+    s.crc = calib_crc(&s);
+    eeprom_update_block(&s, &calibStore, sizeof(s));
+}
+
+uint8_t calib_count(void) {
+    return curveLen;
+}
+
+calib_point_t calib_point(uint8_t i) {
+    return curve[i];
+}
+
+// Segment search plus one 32-bit multiply and shifts, no divide
+int16_t calib_score(long raw) {
+    if (raw <= curve[0].raw) return curve[0].score;
+    if (raw >= curve[curveLen - 1].raw) return curve[curveLen - 1].score; // clamp, never extrapolate
+
+    for (uint8_t i = 1; i < curveLen; i++) {
+        if (raw < curve[i].raw) {
+            long dx = (raw - curve[i - 1].raw) >> 8;
+            return curve[i - 1].score + (int16_t)((dx * slope[i - 1] + 0x8000) >> 16);
+        }
+    }
+    return curve[curveLen - 1].score;
+}
@@ -0,0 +1,28 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+#include <stdint.h>
+
+// Piecewise-linear raw -> display score curve with strictly increasing
+// raw points. Below the first point the first score applies, above the
+// last point the last score (which is the clamp). Lookups work in steps of
+// 256 raw counts, so neighbouring points must be at least that far apart
+#ifndef CALIB_MAX_POINTS
+#define CALIB_MAX_POINTS 8
+#endif
+#define CALIB_MIN_SPAN 256
+
+typedef struct {
+    long raw;
+    int16_t score;
+} calib_point_t;
+
+void calib_init(void);                  // EEPROM curve if valid, else built-in
+bool calib_load(const calib_point_t *points, uint8_t n);
+void calib_save(void);
+void calib_reset(void);                 // built-in curve, EEPROM copy erased
+uint8_t calib_count(void);
+calib_point_t calib_point(uint8_t i);
+int16_t calib_score(long raw);
+
+#endif
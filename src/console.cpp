@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+#include <avr/pgmspace.h>
+#include "console.h"
+#include "UART.h"
+
+// Tokens are built in place as bytes arrive; nothing is buffered beyond
+// the command itself
+static console_cmd_t cmd;
+static uint8_t words;       // words completed on this line
+static uint8_t len;         // length of the token being read, 0 = between tokens
+static bool number;
+static bool negative;
+static long value;
+static bool done;           // cmd was returned, start over on the next byte
+static uint16_t rxDropped;  // USART_RxDropped() when last looked at
+
+static void console_clear(void) {
+    memset(&cmd, 0, sizeof(cmd));
+    words = 0;
+    len = 0;
+    done = false;
+}
+
+static void console_end_token(void) {
+    if (!len) return;
+
+    if (number) {
+        if (negative && len == 1) cmd.error = true; // a lone '-'
+        if (cmd.argc < CONSOLE_MAX_ARGS) cmd.args[cmd.argc++] = negative ? -value : value;
+        else cmd.error = true;
+    } else {
+        words++;
+    }
+    len = 0;
+}
+
+static void console_start_token(char c) {
+    number = (c == '-' || (c >= '0' && c <= '9'));
+    negative = false;
+    value = 0;
+
+    // Words only ahead of the numbers, at most verb and noun
+    if (!number && (cmd.argc || words >= 2)) cmd.error = true;
+}
+
+static void console_add(char c) {
+    // Printable ASCII only; anything else is line noise, e.g. bytes
+    // received at the wrong baud rate
+    if (c < ' ' || c > '~') cmd.error = true;
+    if (!len) console_start_token(c);
+
+    if (number) {
+        if (c == '-' && len == 0) {
+            negative = true;
+        } else if (c >= '0' && c <= '9') {
+            // Past LONG_MAX the value would wrap into a wrong but valid number
+            if (value > (LONG_MAX - (c - '0')) / 10) cmd.error = true;
+            else value = value * 10 + (c - '0');
+        } else {
+            cmd.error = true;
+        }
+    } else if (!cmd.error) {
+        char *word = words ? cmd.noun : cmd.verb;
+        if (len < CONSOLE_WORD_MAX - 1) {
+            word[len] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+        } else {
+            cmd.error = true;
+        }
+    }
+    len++;
+}
+
+const console_cmd_t *console_poll(void) {
+    uint8_t c;
+    while (USART_Receive(&c)) {
+        if (done) console_clear();
+
+        // Bytes lost to a full RX ring: whatever line they belonged to is cut
+        uint16_t dropped = USART_RxDropped();
+        if (dropped != rxDropped) {
+            rxDropped = dropped;
+            cmd.error = true;
+        }
+
+        if (c == '\r' || c == '\n') {
+            console_end_token();
+            if (!words && !cmd.argc && !cmd.error) continue; // blank line, or LF of a CRLF
+            done = true;
+            return &cmd;
+        }
+        if (c == ' ' || c == '\t' || c == ',') {
+            console_end_token();
+        } else {
+            console_add((char)c);
+        }
+    }
+    return NULL;
+}
+
+bool console_is(const console_cmd_t *c, const char *verb, const char *noun) {
+    return strcmp_P(c->verb, verb) == 0 && strcmp_P(c->noun, noun) == 0;
+}
@@ -0,0 +1,33 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+// Line-oriented command console; each call drains the RX ring and returns
+// at most one completed line:
+//   <verb> [<noun>] [<number> ...]
+// Words are lower-cased; numbers are decimal and may be negative
+#ifndef CONSOLE_WORD_MAX
+#define CONSOLE_WORD_MAX 10
+#endif
+#ifndef CONSOLE_MAX_ARGS
+#define CONSOLE_MAX_ARGS 16
+#endif
+
+typedef struct {
+    char verb[CONSOLE_WORD_MAX];
+    char noun[CONSOLE_WORD_MAX];
+    long args[CONSOLE_MAX_ARGS];
+    uint8_t argc;
+    bool error;             // unprintable byte, word too long, too many tokens, bad or out-of-range number
+} console_cmd_t;
+
+// Drains the RX ring, O(1) per byte. Returns the command as soon as its line
+// is complete (valid until the next call, the rest stays queued), NULL once
+// the ring is empty. A line that lost bytes to RX overrun comes back as error
+const console_cmd_t *console_poll(void);
+
+// verb and noun in PROGMEM; an empty noun matches a command without one
+bool console_is(const console_cmd_t *cmd, const char *verb, const char *noun);
+
+#endif
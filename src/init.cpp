@@ -9,11 +9,10 @@
 #include "UART.h"
 #include "init.h"
 
-// Loadcell
-#define HX_DOUT PD5   // Digital input
-#define HX_SCK  PD4   // Digital output
 #define TIMER1_COMPARE_VALUE 499 
 
+extern volatile unsigned long system_ticks;
+
 
 // =======================================================
 // =================== INITIALIZATION ====================
@@ -38,47 +37,18 @@ void Hardware_Init(void) {
 }
 
 
-void hx711_init(void) {
-    // DOUT as input
-    DDRD &= ~(1 << HX_DOUT);
-
-    // SCK as output
-    DDRD |= (1 << HX_SCK);
-    PORTD &= ~(1 << HX_SCK);   // Start low
-}
-
-long hx711_read(void) {
-    long value = 0;
-    while (PIND & (1 << HX_DOUT)); // Wait for ready
-
+// CPU cycles since boot from system_ticks and TCNT1, for profiling.
+// Wraps every ~268 s, so only differences are meaningful
+uint32_t sys_cycles(void) {
     uint8_t oldSREG = SREG;
-    cli(); // Disable interrupts during the 24-bit read
-
-    for (uint8_t i = 0; i < 24; i++) {
-        PORTD |= (1 << HX_SCK);
-        _delay_us(1);
-        value = value << 1;
-        PORTD &= ~(1 << HX_SCK);
-        _delay_us(1);
-        if (PIND & (1 << HX_DOUT)) {
-            value++;
-        }
-    }
-
-    // 3 pulses for Channel A (Gain 64)
-    // Use 1 pulse for Channel A (Gain 128)
-    // Use 2 pulses for Channel B (Gain 32)
-    for (uint8_t i = 0; i < 3; i++) {
-        PORTD |= (1 << HX_SCK);
-        _delay_us(1);
-        PORTD &= ~(1 << HX_SCK);
-        _delay_us(1);
-    }
-
-    SREG = oldSREG; // Re-enable interrupts
-
-    if (value & 0x800000) value |= 0xFF000000; // Sign extend
-    return value;
+    cli();
+    unsigned long t = system_ticks;
+    uint16_t cnt = TCNT1;
+    // Compare match already happened but its ISR hasn't run yet
+    if ((TIFR1 & (1 << OCF1A)) && cnt < TIMER1_COMPARE_VALUE / 2) t += 2;
+    SREG = oldSREG;
+
+    return t * (F_CPU / 1000) + (uint32_t)cnt * 64;
 }
 
 void sys_init() {
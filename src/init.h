@@ -1,9 +1,10 @@
 #ifndef INIT_H
 #define INIT_H
 
+#include <stdint.h>
+
 void Hardware_Init(void);
-void hx711_init(void);
-long hx711_read(void);
 void sys_init();
+uint32_t sys_cycles(void);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <avr/io.h>
 #include <util/delay.h>
 #include <stdint.h>
+#include <avr/pgmspace.h>
 #include "lcd.h"
 
 static void lcd_put_nibble(uint8_t nibble) {
@@ -62,6 +63,11 @@ void lcd_puts(const char *s) {
     while (*s) lcd_data(*s++);
 }
 
+void lcd_puts_P(const char *s) {
+    char c;
+    while ((c = pgm_read_byte(s++))) lcd_data(c);
+}
+
 void lcd_putnum(int32_t num) {
     char buf[12];  // cukup untuk -2147483648
     int i = 0;
@@ -42,6 +42,8 @@ void lcd_goto(uint8_t col, uint8_t row);
 
 void lcd_puts(const char *s);
 
+void lcd_puts_P(const char *s);   /* string in PROGMEM */
+
 void lcd_putnum(int32_t num);
 
 /* ---------------- initialization ---------------- */
@@ -0,0 +1,279 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "loadcell.h"
+#include "UART.h"
+
+// =======================================================
+// ===================== TARE ============================
+// =======================================================
+
+static uint16_t isqrt32(uint32_t v) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+void tare_begin(tare_cal_t *t) {
+    t->n = 0;
+    t->mean_q8 = 0;
+    t->m2_q16 = 0;
+}
+
+bool tare_add(tare_cal_t *t, long raw) {
+    // Q8 fits a 24-bit conversion; boot-time only, so the divide is fine
+    long x = raw * 256L;
+    long delta = x - t->mean_q8;
+
+    t->n++;
+    t->mean_q8 += delta / t->n;
+    t->m2_q16 += (int64_t)delta * (x - t->mean_q8);
+
+    if (t->n >= TARE_MAX_SAMPLES) return true;
+    if (t->n < TARE_MIN_SAMPLES) return false;
+
+    // sigma^2 / n <= tol^2  <=>  M2 <= tol^2 * n * (n - 1)
+    int64_t limit = (int64_t)TARE_TOLERANCE * TARE_TOLERANCE * t->n * (t->n - 1);
+    return t->m2_q16 <= (limit << 16);
+}
+
+long tare_mean(const tare_cal_t *t) {
+    return t->mean_q8 >> 8;
+}
+
+long tare_sigma(const tare_cal_t *t) {
+    if (t->n < 2) return 0;
+
+    int64_t var = (t->m2_q16 >> 16) / (t->n - 1);
+    if (var > 0xFFFFFFFFLL) var = 0xFFFFFFFFLL;
+    return isqrt32((uint32_t)var);
+}
+
+long hit_threshold(long sigma) {
+    long th = HIT_SIGMA_K * sigma;
+    return (th > HIT_MIN_DELTA) ? th : HIT_MIN_DELTA;
+}
+
+long tare_threshold(const tare_cal_t *t) {
+    return hit_threshold(tare_sigma(t));
+}
+
+// =======================================================
+// =================== AUTO-ZERO =========================
+// =======================================================
+
+void autozero_begin(autozero_t *z, long baseline, long sigma, unsigned long ticks) {
+    long gate = AUTOZERO_REJECT_K * sigma;
+
+    z->base_q8 = baseline * 256L;
+    z->gate = (gate > AUTOZERO_GATE_MIN) ? gate : AUTOZERO_GATE_MIN;
+    z->rejecting = false;
+    z->window_base = baseline;
+    z->window_ticks = ticks;
+    z->drift = 0;
+}
+
+// Only feed samples taken with nothing on the pad (idle, no hit)
+void autozero_update(autozero_t *z, long raw, unsigned long ticks) {
+    long base = z->base_q8 >> 8;
+
+    if (labs(raw - base) > z->gate) {
+        // A bump to the cabinet: leave the zero alone unless the offset
+        // persists, in which case the zero itself has moved
+        if (!z->rejecting) {
+            z->rejecting = true;
+            z->reject_since = ticks;
+        } else if (ticks - z->reject_since >= AUTOZERO_RELEARN_MS) {
+            z->base_q8 = raw * 256L;
+            z->rejecting = false;
+        }
+    } else {
+        z->rejecting = false;
+        z->base_q8 += ((raw * 256L) - z->base_q8) >> AUTOZERO_SHIFT;
+    }
+
+    // Drift rate, once per window (which may have been stretched by a game)
+    unsigned long elapsed = ticks - z->window_ticks;
+    if (elapsed >= AUTOZERO_DRIFT_MS) {
+        base = z->base_q8 >> 8;
+        z->drift = (long)((int64_t)(base - z->window_base) * 60000L / (long)elapsed);
+        z->window_base = base;
+        z->window_ticks = ticks;
+    }
+}
+
+long autozero_baseline(const autozero_t *z) {
+    return z->base_q8 >> 8;
+}
+
+long autozero_drift(const autozero_t *z) {
+    return z->drift;
+}
+
+// =======================================================
+// ===================== FILTER ==========================
+// =======================================================
+
+void filter_reset(filter_t *f) {
+    f->primed = false;
+}
+
+#if FILTER_MEDIAN_TAPS > 1
+static inline void order(long &a, long &b) {
+    if (a > b) { long t = a; a = b; b = t; }
+}
+
+static long median(const long *taps) {
+    long a = taps[0], b = taps[1], c = taps[2];
+#if FILTER_MEDIAN_TAPS == 5
+    // Median of 5 in 7 compare/swaps
+    long d = taps[3], e = taps[4];
+    order(a, b); order(d, e);
+    order(a, d); order(b, e);   // a and e can't be the median now
+    order(b, c); order(c, d);   // median of b, c, d
+    order(b, c);
+    return c;
+#else
+    order(a, b); order(b, c); order(a, b);
+    return b;
+#endif
+}
+#endif
+
+long filter_update(filter_t *f, long raw) {
+    if (!f->primed) {
+#if FILTER_MEDIAN_TAPS > 1
+        for (uint8_t i = 0; i < FILTER_MEDIAN_TAPS; i++) f->taps[i] = raw;
+        f->pos = 0;
+#endif
+        f->iir_q8 = raw * 256L;
+        f->primed = true;
+    }
+
+    long x = raw;
+#if FILTER_MEDIAN_TAPS > 1
+    f->taps[f->pos] = raw;
+    if (++f->pos == FILTER_MEDIAN_TAPS) f->pos = 0;
+    x = median(f->taps);
+#endif
+
+#if FILTER_IIR_SHIFT > 0
+    f->iir_q8 += ((x * 256L) - f->iir_q8) >> FILTER_IIR_SHIFT;
+    x = f->iir_q8 >> 8;
+#endif
+    return x;
+}
+
+// Run a synthetic ramp through a scratch filter with interrupts off
+// (32 samples stay well inside one 2 ms tick). Timed from TCNT1 alone:
+// a compare match pending on entry can't be told from one during the run
+uint16_t filter_bench(void) {
+    filter_t f;
+    volatile long sink;
+    volatile long step = 12345;
+
+    filter_reset(&f);
+    filter_update(&f, 0);
+
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t c0 = TCNT1;
+    for (uint8_t i = 0; i < 32; i++) {
+        sink = filter_update(&f, (long)i * step);
+    }
+    uint16_t c1 = TCNT1;
+    SREG = oldSREG;
+
+    // at most one CTC wrap back to 0 after OCR1A
+    uint16_t counts = (c1 >= c0) ? c1 - c0 : c1 + OCR1A + 1 - c0;
+
+    (void)sink;
+    return (uint16_t)(((uint32_t)counts * 64) >> 5);
+}
+
+// =======================================================
+// ===================== CAPTURE =========================
+// =======================================================
+
+void capture_reset(capture_t *c) {
+    c->pos = 0;
+    c->pre = 0;
+    c->post = 0;
+    c->state = CAPTURE_ARMED;
+    c->primed = false;
+}
+
+// Live path: one subtract, a clamp and one 16-bit store per sample
+void capture_add(capture_t *c, long raw) {
+    long v = raw >> CAPTURE_SHIFT;
+    if (!c->primed) {
+        c->anchor = c->last = v;
+        c->primed = true;
+    }
+    // A step beyond the int16 range is clipped and the rest carried into
+    // the next deltas: the dump slews for a sample instead of wrapping
+    long step = v - c->last;
+    if (step > 32767) step = 32767;
+    else if (step < -32767) step = -32767;
+    int16_t d = (int16_t)step;
+    c->last += d;
+
+    if (c->state == CAPTURE_ARMED) {
+        // Evicting the oldest delta moves the anchor past it
+        if (c->pre == CAPTURE_PRE) c->anchor += c->delta[c->pos];
+        else c->pre++;
+        c->delta[c->pos] = d;
+        c->pos = (c->pos + 1) & (CAPTURE_PRE - 1);
+    } else if (c->state == CAPTURE_RUNNING) {
+        c->delta[CAPTURE_PRE + c->post] = d;
+        if (++c->post == CAPTURE_POST) c->state = CAPTURE_DONE;
+    }
+}
+
+void capture_trigger(capture_t *c) {
+    if (c->state == CAPTURE_ARMED) c->state = CAPTURE_RUNNING;
+}
+
+void capture_stop(capture_t *c) {
+    c->state = CAPTURE_DONE;
+}
+
+// Rebuilds raw counts (to CAPTURE_SHIFT resolution), oldest first; the
+// last pre-trigger sample is the one that crossed the threshold
+void capture_dump(const capture_t *c, long baseline, long threshold) {
+    USART_PrintString_P(PSTR("Hit capture: pre "));
+    USART_PrintNumber(c->pre);
+    USART_PrintString_P(PSTR(", post "));
+    USART_PrintNumber(c->post);
+    USART_PrintString_P(PSTR(", baseline "));
+    USART_PrintNumber(baseline);
+    USART_PrintString_P(PSTR(", threshold "));
+    USART_PrintNumber(threshold);
+    USART_PrintString_P(PSTR("\n"));
+
+    long v = c->anchor;
+    uint8_t slot = (c->pos - c->pre) & (CAPTURE_PRE - 1);
+    for (uint8_t i = 0; i < c->pre + c->post; i++) {
+        if (i < c->pre) {
+            v += c->delta[slot];
+            slot = (slot + 1) & (CAPTURE_PRE - 1);
+        } else {
+            v += c->delta[CAPTURE_PRE + i - c->pre];
+        }
+        USART_PrintNumber(v * (1L << CAPTURE_SHIFT));
+        USART_PrintString_P((i + 1 == c->pre) ? PSTR(" <\n") : PSTR("\n"));
+    }
+}
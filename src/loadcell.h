@@ -0,0 +1,136 @@
+#ifndef LOADCELL_H
+#define LOADCELL_H
+
+#include <stdint.h>
+
+// Boot tare: stop once the standard error of the mean is below tolerance
+#ifndef TARE_MIN_SAMPLES
+#define TARE_MIN_SAMPLES 16
+#endif
+#ifndef TARE_MAX_SAMPLES
+#define TARE_MAX_SAMPLES 160
+#endif
+#ifndef TARE_TOLERANCE
+#define TARE_TOLERANCE 64       // raw counts
+#endif
+
+// Hit threshold = HIT_SIGMA_K * noise sigma above tare. HIT_MIN_DELTA only
+// catches a sigma that came out near zero (a stuck or unplugged cell reads
+// a constant), which would otherwise trigger on a few counts of drift
+#ifndef HIT_MIN_DELTA
+#define HIT_MIN_DELTA 2000L
+#endif
+#ifndef HIT_SIGMA_K
+#define HIT_SIGMA_K 8
+#endif
+
+// Welford running mean/variance, mean in Q8 and M2 in Q16 raw counts
+typedef struct {
+    uint8_t n;
+    long mean_q8;
+    int64_t m2_q16;
+} tare_cal_t;
+
+// Idle auto-zero: EMA baseline with alpha = 2^-AUTOZERO_SHIFT
+#ifndef AUTOZERO_SHIFT
+#define AUTOZERO_SHIFT 6
+#endif
+#ifndef AUTOZERO_REJECT_K
+#define AUTOZERO_REJECT_K 4         // ignore samples beyond K * sigma
+#endif
+#ifndef AUTOZERO_GATE_MIN
+#define AUTOZERO_GATE_MIN 256L      // raw counts
+#endif
+#ifndef AUTOZERO_RELEARN_MS
+#define AUTOZERO_RELEARN_MS 30000UL // rejected this long = real zero shift
+#endif
+#ifndef AUTOZERO_DRIFT_MS
+#define AUTOZERO_DRIFT_MS 60000UL   // drift rate measurement window
+#endif
+
+typedef struct {
+    long base_q8;
+    long gate;
+    bool rejecting;
+    unsigned long reject_since;
+    long window_base;
+    unsigned long window_ticks;
+    long drift;                     // counts per minute
+} autozero_t;
+
+// Sample filter ahead of hit detection: running median (0, 3 or 5 taps)
+// for spike rejection, then y += (x - y) >> FILTER_IIR_SHIFT (0 = off).
+// Off by default: at 10 SPS a punch can be a single sample, which a
+// median would discard; worth 3 taps on a board strapped for 80 SPS
+#ifndef FILTER_MEDIAN_TAPS
+#define FILTER_MEDIAN_TAPS 0
+#endif
+#if FILTER_MEDIAN_TAPS != 0 && FILTER_MEDIAN_TAPS != 3 && FILTER_MEDIAN_TAPS != 5
+#error "FILTER_MEDIAN_TAPS must be 0, 3 or 5"
+#endif
+#ifndef FILTER_IIR_SHIFT
+#define FILTER_IIR_SHIFT 1
+#endif
+
+typedef struct {
+#if FILTER_MEDIAN_TAPS > 1
+    long taps[FILTER_MEDIAN_TAPS];
+    uint8_t pos;
+#endif
+    long iir_q8;
+    bool primed;
+} filter_t;
+
+// Hit waveform capture: CAPTURE_PRE samples (power of 2) up to and
+// including the trigger, then up to CAPTURE_POST more until the hit ends.
+// Samples are kept as 16-bit deltas of (raw >> CAPTURE_SHIFT). At shift 8
+// one delta spans +/-8.4M counts (half the 24-bit range); a larger step
+// between two samples is spread over the following ones
+#ifndef CAPTURE_PRE
+#define CAPTURE_PRE 32
+#endif
+#ifndef CAPTURE_POST
+#define CAPTURE_POST 64
+#endif
+#ifndef CAPTURE_SHIFT
+#define CAPTURE_SHIFT 8
+#endif
+
+#define CAPTURE_ARMED   0
+#define CAPTURE_RUNNING 1
+#define CAPTURE_DONE    2
+
+typedef struct {
+    int16_t delta[CAPTURE_PRE + CAPTURE_POST];
+    long anchor;        // scaled value before the oldest delta
+    long last;          // scaled value of the newest sample
+    uint8_t pos;        // next pre-trigger slot
+    uint8_t pre;
+    uint8_t post;
+    uint8_t state;
+    bool primed;
+} capture_t;
+
+void tare_begin(tare_cal_t *t);
+bool tare_add(tare_cal_t *t, long raw);         // true once converged
+long tare_mean(const tare_cal_t *t);
+long tare_sigma(const tare_cal_t *t);           // measured noise floor
+long tare_threshold(const tare_cal_t *t);
+long hit_threshold(long sigma);          // same rule from a known sigma
+
+void autozero_begin(autozero_t *z, long baseline, long sigma, unsigned long ticks);
+void autozero_update(autozero_t *z, long raw, unsigned long ticks);
+long autozero_baseline(const autozero_t *z);
+long autozero_drift(const autozero_t *z);
+
+void filter_reset(filter_t *f);
+long filter_update(filter_t *f, long raw);
+uint16_t filter_bench(void);                    // CPU cycles per sample
+
+void capture_reset(capture_t *c);
+void capture_add(capture_t *c, long raw);
+void capture_trigger(capture_t *c);
+void capture_stop(capture_t *c);
+void capture_dump(const capture_t *c, long baseline, long threshold);
+
+#endif
@@ -1,9 +1,13 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
+#include <util/crc16.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdio.h>
 
 // Project headers (assumed present)
@@ -13,11 +17,19 @@
 #include "UART.h"
 #include "lcd.h"
 #include "init.h"
+#include "HX711.h"
+#include "loadcell.h"
+#include "score.h"
+#include "calib.h"
+#include "telemetry.h"
+#include "console.h"
+#include "ui_text.h"
 
 // -------------------------------------------------------------------------
 // CONFIG / GLOBALS
 // -------------------------------------------------------------------------
-DMD led_module(1, 1); // 1x1 panel
+DMD led_module(1, 1, true); // 1x1 panel, double-buffered
+HX711 scale(HX711_GAIN_64);  // channel A, gain 64
 
 // Game state
 volatile bool gameActive = false;
@@ -28,6 +40,11 @@ volatile uint16_t msCounter = 0;          // ms accumulator
 volatile int8_t  gameTimer = 0;           // countdown in seconds
 volatile bool    updateScreen = false;    // request screen redraw
 volatile unsigned long system_ticks = 0;  // simple millis replacement
+volatile uint16_t isrLatencyMax = 0;      // worst Timer1 entry delay, 4 us units
+
+// Retained labels: only changed digits are redrawn
+DMDTextField timerField;
+DMDTextField scoreField;
 
 // Idle animation
 int xPunch = 0, dirPunch = 1;
@@ -36,12 +53,24 @@ unsigned long lastAnimTime = 0;
 
 // HX711 / coin / scoring variables
 int TimerForGame = 20; // default 20s
+long hitThreshold = 0; // fixed hit threshold, 0 = from tare noise
 volatile uint32_t sensor_counter = 0;
 
-long tare_value[160];
-long average_tare = 0;
-long hit_value = 0;
-long score = 0;           // raw peak value
+// One per load cell; all of them are read on the shared HX711 clock
+typedef struct {
+    long average_tare;    // zero reference, tracked by auto-zero while idle
+    long tare_noise;      // tare sigma, raw counts
+    long hit_value;       // hit threshold above average_tare
+    autozero_t zero;
+    filter_t filter;      // median + IIR ahead of detection and auto-zero
+    score_t score;
+    long prevDeviation;
+} pad_t;
+
+pad_t pads[HX711_CHANNELS];
+capture_t hitCapture;     // raw waveform around the last hit (pad 0)
+long score = 0;           // hit score above baseline, raw counts
+uint8_t scorePad = 0;     // pad that produced it
 int display_score = 0;    // 0..100 percent shown on display
 bool waiting_for_release = false;
 
@@ -57,14 +86,18 @@ volatile uint8_t g_button_event = 0;
 void sys_init(void);
 void delay_soft_ms(unsigned long ms);
 void tampilkanIdleBergerak(void);
-void handleGameLogic(void);
+void handleGameLogic(const hx711_sample_t &sample);
 void tampilkanHighScore(void);
+void reportIsrLatency(void);
+void pollSerialCommand(void);
+void loadSettings(void);
+void saveSettings(void);
+void applyThreshold(void);
 
 void USART_Init(void);
 void Hardware_Init(void);
-void hx711_init(void);
-long hx711_read(void);
 void USART_PrintString(const char* str);
+void USART_PrintString_P(const char* str);
 void USART_PrintNumber(uint32_t num);
 
 
@@ -73,6 +106,7 @@ void lcd_clear(void);
 void lcd_home(void);
 void lcd_putc(char c);
 void lcd_puts(const char *s);
+void lcd_puts_P(const char *s);
 void lcd_goto(uint8_t x, uint8_t y);
 void lcd_putnum(int32_t num);
 
@@ -93,6 +127,11 @@ ISR(INT1_vect) {
 
 // Timer1 Compare A ISR: drives display refresh and timekeeping
 ISR(TIMER1_COMPA_vect) {
+    // CTC restarted TCNT1 at the match, so it now holds our entry latency
+    // (0..OCR1A, wider than a byte)
+    uint16_t latency = TCNT1;
+    if (latency > isrLatencyMax) isrLatencyMax = latency;
+
     // Refresh display (non-blocking)
     led_module.scanDisplayBySPI();
 
@@ -111,6 +150,431 @@ ISR(TIMER1_COMPA_vect) {
     }
 }
 
+// Worst Timer1 interrupt latency seen during the last game
+void reportIsrLatency(void) {
+    cli();
+    uint16_t latency = isrLatencyMax;
+    isrLatencyMax = 0;
+    sei();
+
+    USART_PrintString_P(PSTR("ISR latency max: "));
+    USART_PrintNumber((uint32_t)latency * 4);
+    USART_PrintString_P(PSTR(" us\n"));
+}
+
+// -------------------------------------------------------------------------
+// SETTINGS (EEPROM, written by "save")
+// -------------------------------------------------------------------------
+#define SETTINGS_MAGIC 0x5E
+
+typedef struct {
+    uint8_t magic;
+    uint8_t timer;        // TimerForGame
+    uint8_t formula;      // score_formula
+    uint8_t mask;         // telemetry_mask
+    long threshold;       // hitThreshold
+    uint8_t crc;
+} settings_t;
+
+static settings_t settingsStore EEMEM;
+
+static uint8_t settingsCrc(const settings_t *s) {
+    const uint8_t *p = (const uint8_t *)s;
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < offsetof(settings_t, crc); i++) {
+        crc = _crc8_ccitt_update(crc, p[i]);
+    }
+    return crc;
+}
+
+// Keeps the compiled-in defaults unless a valid copy was saved
+void loadSettings(void) {
+    settings_t s;
+    eeprom_read_block(&s, &settingsStore, sizeof(s));
+    if (s.magic != SETTINGS_MAGIC || s.crc != settingsCrc(&s)) return;
+
+    TimerForGame = s.timer;
+    score_formula = s.formula;
+    telemetry_mask = s.mask;
+    hitThreshold = s.threshold;
+}
+
+void saveSettings(void) {
+    settings_t s;
+    s.magic = SETTINGS_MAGIC;
+    s.timer = TimerForGame;
+    s.formula = score_formula;
+    s.mask = telemetry_mask;
+    s.threshold = hitThreshold;
+    s.crc = settingsCrc(&s);
+    eeprom_update_block(&s, &settingsStore, sizeof(s));
+}
+
+void applyThreshold(void) {
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        pads[ch].hit_value = hitThreshold ? hitThreshold : hit_threshold(pads[ch].tare_noise);
+    }
+}
+
+// -------------------------------------------------------------------------
+// SERIAL CONSOLE (main loop and blocking screens; one command per call)
+// -------------------------------------------------------------------------
+//   stats                        counters and per-pad state
+//   get baseline                 auto-zero baseline and drift per pad
+//   get timer|formula|mask|threshold
+//   set timer <s>                game length, 1..99
+//   set formula <n>              SCORE_PEAK .. SCORE_BLEND
+//   set mask <n>                 telemetry record mask
+//   set threshold <counts>       fixed hit threshold, 0 = from tare noise
+//   curve                        print the calibration curve
+//   curve <raw> <score> ...      replace it (2..8 points, raw >= 256 apart)
+//   dump hit                     waveform of the last hit (idle only)
+//   save                         settings and curve to EEPROM
+//   baud                         selectable rates and their error
+//   baud <rate>                  switch; reverts unless a command runs
+//                                OK at the new rate within BAUD_CONFIRM_MS
+#ifndef BAUD_CONFIRM_MS
+#define BAUD_CONFIRM_MS 10000
+#endif
+
+static uint32_t baudFallback = 0;        // rate to go back to, 0 = confirmed
+static uint32_t baudRequest = 0;         // switch once the OK is out, 0 = none
+static unsigned long baudChangedAt = 0;
+
+static void printValue(const char *name, long value) {
+    USART_PrintString_P(name);
+    USART_PrintNumber(value);
+    USART_PrintString_P(PSTR("\r\n"));
+}
+
+static void printStats(void) {
+    cli();
+    uint16_t latency = isrLatencyMax;
+    sei();
+
+    printValue(PSTR("ISR latency max us: "), (long)latency * 4);
+    printValue(PSTR("TX dropped: "), USART_TxDropped());
+    printValue(PSTR("RX dropped: "), USART_RxDropped());
+    printValue(PSTR("Frames dropped: "), tlm_dropped());
+    printValue(PSTR("HX711 overruns: "), scale.overruns());
+    printValue(PSTR("HX711 SPS: "), scale.sampleRate());
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        printValue(PSTR("Pad: "), ch);
+        printValue(PSTR("  baseline: "), autozero_baseline(&pads[ch].zero));
+        printValue(PSTR("  drift/min: "), autozero_drift(&pads[ch].zero));
+        printValue(PSTR("  noise: "), pads[ch].tare_noise);
+        printValue(PSTR("  hit value: "), pads[ch].hit_value);
+    }
+}
+
+static bool setValue(const console_cmd_t *cmd) {
+    if (cmd->argc != 1) return false;
+    long v = cmd->args[0];
+
+    if (console_is(cmd, PSTR("set"), PSTR("timer"))) {
+        if (v < 1 || v > 99) return false;
+        TimerForGame = v;
+    } else if (console_is(cmd, PSTR("set"), PSTR("formula"))) {
+        if (v < SCORE_PEAK || v > SCORE_BLEND) return false;
+        score_formula = v;
+    } else if (console_is(cmd, PSTR("set"), PSTR("mask"))) {
+        if (v < 0 || v > 0xFF) return false;
+        telemetry_mask = v;
+    } else if (console_is(cmd, PSTR("set"), PSTR("threshold"))) {
+        if (v < 0) return false;
+        hitThreshold = v;
+        applyThreshold();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool getValue(const console_cmd_t *cmd) {
+    if (cmd->argc) return false;
+
+    if (console_is(cmd, PSTR("get"), PSTR("baseline"))) {
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+            USART_PrintString_P(PSTR("Baseline: "));
+            USART_PrintNumber(autozero_baseline(&pads[ch].zero));
+            USART_PrintString_P(PSTR(", drift/min: "));
+            USART_PrintNumber(autozero_drift(&pads[ch].zero));
+            USART_PrintString_P(PSTR("\r\n"));
+        }
+    } else if (console_is(cmd, PSTR("get"), PSTR("timer"))) {
+        printValue(PSTR(""), TimerForGame);
+    } else if (console_is(cmd, PSTR("get"), PSTR("formula"))) {
+        printValue(PSTR(""), score_formula);
+    } else if (console_is(cmd, PSTR("get"), PSTR("mask"))) {
+        printValue(PSTR(""), telemetry_mask);
+    } else if (console_is(cmd, PSTR("get"), PSTR("threshold"))) {
+        printValue(PSTR(""), hitThreshold);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool setCurve(const console_cmd_t *cmd) {
+    if (cmd->noun[0]) return false;
+
+    if (cmd->argc == 0) {
+        for (uint8_t i = 0; i < calib_count(); i++) {
+            calib_point_t p = calib_point(i);
+            USART_PrintNumber(p.raw);
+            USART_PrintString_P(PSTR(" -> "));
+            USART_PrintNumber(p.score);
+            USART_PrintString_P(PSTR("\r\n"));
+        }
+        return true;
+    }
+    if (cmd->argc & 1) return false;
+
+    calib_point_t points[CALIB_MAX_POINTS];
+    uint8_t n = cmd->argc >> 1;
+    if (n > CALIB_MAX_POINTS) return false;
+    for (uint8_t i = 0; i < n; i++) {
+        points[i].raw = cmd->args[2 * i];
+        points[i].score = cmd->args[2 * i + 1];
+    }
+    return calib_load(points, n);
+}
+
+static bool setBaud(const console_cmd_t *cmd) {
+    if (cmd->noun[0] || cmd->argc > 1) return false;
+
+    if (cmd->argc == 0) {
+        for (uint8_t i = 0; i < USART_BaudCount(); i++) {
+            usart_baud_t b = USART_BaudEntry(i);
+            int8_t err = b.error < 0 ? -b.error : b.error;
+            USART_PrintNumber(b.baud);
+            USART_PrintString_P(b.error < 0 ? PSTR(" -") : PSTR(" +"));
+            USART_PrintNumber(err / 10);
+            USART_PrintString_P(PSTR("."));
+            USART_PrintNumber(err % 10);
+            USART_PrintString_P(PSTR("%"));
+            if (b.u2x) USART_PrintString_P(PSTR(" U2X"));
+            if (err > USART_MAX_ERROR) USART_PrintString_P(PSTR(" (too far off)"));
+            if (b.baud == USART_Baud()) USART_PrintString_P(PSTR(" <"));
+            USART_PrintString_P(PSTR("\r\n"));
+        }
+        return true;
+    }
+
+    uint32_t baud = cmd->args[0];
+    if (baud == USART_Baud()) return true;
+    if (!USART_BaudSupported(baud)) return false;
+
+    USART_PrintString_P(PSTR("Switching, send a command at the new rate to keep it\r\n"));
+    baudRequest = baud;
+    return true;
+}
+
+void pollSerialCommand(void) {
+    if (baudFallback && system_ticks - baudChangedAt > BAUD_CONFIRM_MS) {
+        USART_SetBaud(baudFallback);
+        baudFallback = 0;
+        USART_PrintString_P(PSTR("Baud not confirmed, reverted\r\n"));
+    }
+
+    const console_cmd_t *cmd = console_poll();
+    if (!cmd) return;
+
+    bool ok = !cmd->error;
+    if (!ok) {
+        // fall through to ERR
+    } else if (console_is(cmd, PSTR("stats"), PSTR(""))) {
+        printStats();
+    } else if (!strcmp_P(cmd->verb, PSTR("set"))) {
+        ok = setValue(cmd);
+    } else if (!strcmp_P(cmd->verb, PSTR("get"))) {
+        ok = getValue(cmd);
+    } else if (!strcmp_P(cmd->verb, PSTR("curve"))) {
+        ok = setCurve(cmd);
+    } else if (console_is(cmd, PSTR("dump"), PSTR("hit"))) {
+        // ~100 lines at 9600 baud: never while a game is sampling
+        ok = !gameActive;
+        if (ok) capture_dump(&hitCapture, pads[0].average_tare, pads[0].hit_value);
+    } else if (!strcmp_P(cmd->verb, PSTR("baud"))) {
+        ok = setBaud(cmd);
+    } else if (console_is(cmd, PSTR("save"), PSTR(""))) {
+        saveSettings();
+        calib_save();
+    } else {
+        ok = false;
+    }
+    USART_PrintString_P(ok ? PSTR("OK\r\n") : PSTR("ERR\r\n"));
+
+    // Only a recognized command that ran confirms the rate: line noise at a
+    // mismatched rate can still tokenize cleanly
+    if (ok) baudFallback = 0;
+
+    // USART_SetBaud() flushes, so the OK above goes out at the old rate
+    if (baudRequest) {
+        uint32_t previous = USART_Baud();
+        if (USART_SetBaud(baudRequest)) {
+            baudFallback = previous;
+            baudChangedAt = system_ticks;
+        }
+        baudRequest = 0;
+    }
+}
+
+// -------------------------------------------------------------------------
+// HIT DETECTION (one HX711 sample per call)
+// -------------------------------------------------------------------------
+void handleGameLogic(const hx711_sample_t &sample) {
+    static unsigned long prevTicks = 0;
+    long deviation[HX711_CHANNELS];
+    bool above = false;
+
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        pad_t &pad = pads[ch];
+        long filtered = filter_update(&pad.filter, sample.value[ch]);
+
+        // the filtered deviation decides when a hit starts and ends; the
+        // score sees the unfiltered one so a short punch keeps its peak
+        if (labs(filtered - pad.average_tare) > pad.hit_value) above = true;
+        deviation[ch] = labs(sample.value[ch] - pad.average_tare);
+
+        tlm_sample(TLM_FILTERED_SAMPLE, sample.ticks, ch, filtered);
+    }
+
+    // detect start of hit on any pad
+    if (above && counting == false) {
+        counting = true;
+        score = 0;
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+            score_begin(&pads[ch].score, pads[ch].prevDeviation, prevTicks);
+        }
+        capture_trigger(&hitCapture);
+    }
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        pads[ch].prevDeviation = deviation[ch];
+    }
+    prevTicks = sample.ticks;
+
+    // during hit: accumulate peak and impulse on every pad
+    if (counting) {
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+            score_add(&pads[ch].score, deviation[ch], sample.ticks);
+        }
+    }
+
+    // end of hit: every pad back below threshold -> finalize
+    if (!above && counting == true) {
+        counting = false;
+        capture_stop(&hitCapture);
+
+        // the hardest-hit pad sets the score
+        score = -1;
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+            long padScore = score_result(&pads[ch].score);
+            if (padScore > score) {
+                score = padScore;
+                scorePad = ch;
+            }
+        }
+        score_t &hitScore = pads[scorePad].score;
+
+        // calibration curve maps raw to 0..999 and clamps
+        display_score = calib_score(score);
+
+        stored_score = score;
+        has_score = true;
+
+        // show score in UART
+        USART_PrintString_P(PSTR("Score: "));
+        USART_PrintNumber(display_score);
+        USART_PrintString_P(PSTR("\n"));
+        USART_PrintString_P(PSTR("\nRaw Score: "));
+        USART_PrintNumber(score);
+        USART_PrintString_P(PSTR("\n"));
+        USART_PrintString_P(PSTR("\nPad: "));
+        USART_PrintNumber(scorePad);
+        USART_PrintString_P(PSTR(", peak: "));
+        USART_PrintNumber(hitScore.peak);
+        USART_PrintString_P(PSTR(", interpolated: "));
+        USART_PrintNumber(score_peak_interp(&hitScore));
+        USART_PrintString_P(PSTR(", impulse: "));
+        USART_PrintNumber(score_impulse(&hitScore));
+        USART_PrintString_P(PSTR("\n"));
+        USART_PrintString_P(PSTR("\nHit Value: "));
+        USART_PrintNumber(pads[scorePad].hit_value);
+        USART_PrintString_P(PSTR("\n"));
+        reportIsrLatency();
+
+        tlm_hit_t summary;
+        summary.ticks = sample.ticks;
+        summary.pad = scorePad;
+        summary.formula = score_formula;
+        summary.peak = hitScore.peak;
+        summary.peak_interp = score_peak_interp(&hitScore);
+        summary.impulse = score_impulse(&hitScore);
+        summary.score = score;
+        summary.display = display_score;
+        tlm_send(TLM_HIT_SUMMARY, &summary, sizeof(summary));
+
+        USART_PrintString_P(PSTR("TX dropped: "));
+        USART_PrintNumber(USART_TxDropped());
+        USART_PrintString_P(PSTR(", frames dropped: "));
+        USART_PrintNumber(tlm_dropped());
+        USART_PrintString_P(PSTR("\n"));
+
+        // Visual score-up animation on DMD
+        char buf[8];
+        int displayScore = 0;
+        int step = display_score / 40;
+        if (step < 1) step = 1;
+        scoreField.x = -1;
+
+        while (displayScore < display_score) {
+            displayScore += step;
+            if (displayScore > display_score) displayScore = display_score;
+
+            int xPos = (displayScore < 10) ? 11 : (displayScore < 100) ? 5 : 1;
+            if (xPos != scoreField.x) {
+                led_module.clearScreen(true);
+                led_module.beginTextField(scoreField, xPos, 0, GRAPHICS_NORMAL);
+            }
+            itoa(displayScore, buf, 10);
+            led_module.updateTextField(scoreField, buf, strlen(buf));
+            led_module.swapBuffers(true);
+
+            delay_soft_ms(30);
+        }
+        delay_soft_ms(2000);
+
+        // check high score and show appropriate screen
+        if (display_score > highScore) {
+            highScore = display_score;
+            USART_PrintString_P(PSTR(">> NEW HIGH SCORE! <<\n"));
+            tampilkanHighScore();
+        } else {
+            led_module.clearScreen(true);
+            led_module.selectFont(SystemFont5x7);
+            led_module.drawString_P(6, 0, ui_high, strlen_P(ui_high), GRAPHICS_NORMAL);
+            led_module.drawString_P(2, 8, ui_score, strlen_P(ui_score), GRAPHICS_NORMAL);
+            led_module.swapBuffers();
+            delay_soft_ms(2000);
+
+            led_module.clearScreen(true);
+            led_module.selectFont(Arial_Black_16, Arial_Black_16_offsets);
+            int hxPos = (highScore < 10) ? 11 : (highScore < 100) ? 5 : 1;
+            itoa(highScore, buf, 10);
+            led_module.drawString(hxPos, 0, buf, strlen(buf), GRAPHICS_NORMAL);
+            led_module.swapBuffers();
+            delay_soft_ms(3000);
+        }
+
+        // After hit processed, stop the game (go back to idle)
+        gameActive = false;
+        score = 0;
+        display_score = 0;
+        has_score = false;
+    }
+}
+
 // -------------------------------------------------------------------------
 // MAIN
 // -------------------------------------------------------------------------
@@ -123,29 +587,66 @@ int main(void) {
     led_module.clearScreen(true);
     USART_Init();
     Hardware_Init();
-    hx711_init();
+    scale.begin();
     initlcd();
 
-    lcd_puts("Insert Coin!");
-
-    // Compute average tare
-    average_tare = 0;
-    for (int i = 0; i < 160; i++) {
-        tare_value[i] = hx711_read();
-        average_tare += tare_value[i];
-        _delay_ms(1);
+    lcd_puts_P(ui_insert_coin);
+
+    calib_init();
+    loadSettings();
+
+    // Tare: running mean/variance per pad, until every mean has settled
+    tare_cal_t tare[HX711_CHANNELS];
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) tare_begin(&tare[ch]);
+    bool settled;
+    do {
+        long raw[HX711_CHANNELS];
+        scale.read(raw);
+        settled = true;
+        for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+            if (!tare_add(&tare[ch], raw[ch])) settled = false;
+        }
+    } while (!settled);
+
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        pad_t &pad = pads[ch];
+        pad.average_tare = tare_mean(&tare[ch]);
+        pad.tare_noise = tare_sigma(&tare[ch]);
+        pad.prevDeviation = 0;
+        autozero_begin(&pad.zero, pad.average_tare, pad.tare_noise, system_ticks);
+        filter_reset(&pad.filter);
+    }
+    applyThreshold();
+
+    // From here on the HX711 is read from its DOUT-ready interrupt
+    scale.start();
+
+    USART_PrintString_P(PSTR("--- System Ready: Sensor(PD2) & Button(PD3) ---\r\n"));
+
+    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+        USART_PrintNumber(pads[ch].average_tare);
+        USART_PrintString_P(PSTR("\r\n"));
+        USART_PrintNumber(pads[ch].hit_value);
+        USART_PrintString_P(PSTR("\r\n"));
+        USART_PrintString_P(PSTR("Tare samples: "));
+        USART_PrintNumber(tare[ch].n);
+        USART_PrintString_P(PSTR(", noise: "));
+        USART_PrintNumber(pads[ch].tare_noise);
+        USART_PrintString_P(PSTR("\r\n"));
     }
-    average_tare = average_tare / 160;
-    _delay_ms(200);
-    hit_value = average_tare - 400000;
-    hit_value = labs(hit_value);
 
-    USART_PrintString("--- System Ready: Sensor(PD2) & Button(PD3) ---\r\n");
+    // Display scan budget for this panel chain
+    DMDScanStats scan;
+    led_module.scanStats(scan);
+    USART_PrintString_P(PSTR("DMD panels: "));
+    USART_PrintNumber(scan.panels);
+    USART_PrintString_P(PSTR(", row: "));
+    USART_PrintNumber(scan.rowCyclesMax);
+    USART_PrintString_P(PSTR(" cyc in Timer1 ISR\r\n"));
 
-    USART_PrintNumber(average_tare);
-    USART_PrintString("\r\n");
-    USART_PrintNumber(hit_value);
-    USART_PrintString("\r\n");
+    USART_PrintString_P(PSTR("Filter: "));
+    USART_PrintNumber(filter_bench());
+    USART_PrintString_P(PSTR(" cyc/sample\r\n"));
 
     sei(); // enable global interrupts
 
@@ -154,6 +655,19 @@ int main(void) {
         // If no game active, show idle animation
         if (!gameActive) {
             tampilkanIdleBergerak();
+
+            // Idle samples only feed the auto-zero
+            hx711_sample_t sample;
+            while (!gameActive && scale.pop(sample)) {
+                for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+                    pad_t &pad = pads[ch];
+                    long filtered = filter_update(&pad.filter, sample.value[ch]);
+                    tlm_sample(TLM_RAW_SAMPLE, sample.ticks, ch, sample.value[ch]);
+                    tlm_sample(TLM_FILTERED_SAMPLE, sample.ticks, ch, filtered);
+                    autozero_update(&pad.zero, filtered, sample.ticks);
+                    pad.average_tare = autozero_baseline(&pad.zero);
+                }
+            }
         }
 
         // If a game is active, run game loop:
@@ -164,13 +678,16 @@ int main(void) {
 
                 // If time expired, show game over and return to idle
                 if (gameTimer < 0) {
-                    USART_PrintString("Waktu Habis.\n");
+                    USART_PrintString_P(PSTR("Waktu Habis.\n"));
+                    reportIsrLatency();
                     led_module.clearScreen(true);
                     led_module.selectFont(SystemFont5x7);
-                    led_module.drawString(6, 4, "TIME", 4, GRAPHICS_NORMAL);
+                    led_module.drawString_P(6, 4, ui_time, strlen_P(ui_time), GRAPHICS_NORMAL);
+                    led_module.swapBuffers();
                     delay_soft_ms(1000);
                     led_module.clearScreen(true);
-                    led_module.drawString(6, 4, "OVER", 4, GRAPHICS_NORMAL);
+                    led_module.drawString_P(6, 4, ui_over, strlen_P(ui_over), GRAPHICS_NORMAL);
+                    led_module.swapBuffers();
                     delay_soft_ms(2000);
 
                     // reset state and go to IDLE
@@ -182,105 +699,28 @@ int main(void) {
                     continue; // go to idle
                 }
 
-                // Draw countdown number
+                // Draw countdown number (full redraw only when it moves)
                 char buf[8];
                 itoa(gameTimer, buf, 10);
-                led_module.clearScreen(true);
                 int xPos = (gameTimer >= 10) ? 5 : 11;
-                led_module.drawString(xPos, 0, buf, strlen(buf), GRAPHICS_NORMAL);
-
-                USART_PrintString("Waktu: ");
-                USART_PrintNumber(gameTimer);
-                USART_PrintString("\n");
-            }
-
-            // 2) Read sensor (polling)
-            long raw = hx711_read();
-            raw = labs(raw);
-            USART_PrintNumber(raw);
-            USART_PrintString("\n");
-            _delay_ms(1);
-
-            // detect start of hit
-            if (raw > hit_value && counting == false) {
-                counting = true;
-                score = 0;
-            }
-
-            // during hit: track max
-            if (counting) {
-                if (raw > score) score = raw;
-
-                // clamp max to 8,000,000 (as in original)
-                if (score >= 8000000) score = 8000000;
-
-                // compute 0..100 percentage properly using integer math:
-                display_score = (int)(((score * 100L) / (800000 - 1))); // 0..999
-
-            }
-
-            // end of hit: raw dropped below threshold -> finalize
-            if (raw <= hit_value && counting == true) {
-                counting = false;
-
-                stored_score = score;
-                has_score = true;
-
-                // show score in UART
-                USART_PrintString("Score: ");
-                USART_PrintNumber(display_score);
-                USART_PrintString("\n");
-                USART_PrintString("\nRaw Score: ");
-                USART_PrintNumber(score);
-                USART_PrintString("\n");
-                USART_PrintString("\nHit Value: ");
-                USART_PrintNumber(hit_value);
-                USART_PrintString("\n");
-
-                // Visual score-up animation on DMD
-                char buf[8];
-                int displayScore = 0;
-                int step = display_score / 40;
-                if (step < 1) step = 1;
-
-                while (displayScore < display_score) {
-                    displayScore += step;
-                    if (displayScore > display_score) displayScore = display_score;
-
+                if (xPos != timerField.x) {
                     led_module.clearScreen(true);
-                    int xPos = (displayScore < 10) ? 11 : (displayScore < 100) ? 5 : 1;
-                    itoa(displayScore, buf, 10);
-                    led_module.drawString(xPos, 0, buf, strlen(buf), GRAPHICS_NORMAL);
-
-                    delay_soft_ms(30);
+                    led_module.beginTextField(timerField, xPos, 0, GRAPHICS_NORMAL);
                 }
-                delay_soft_ms(2000);
+                led_module.updateTextField(timerField, buf, strlen(buf));
+                led_module.swapBuffers(true);
 
-                // check high score and show appropriate screen
-                if (display_score > highScore) {
-                    highScore = display_score;
-                    USART_PrintString(">> NEW HIGH SCORE! <<\n");
-                    tampilkanHighScore();
-                } else {
-                    led_module.clearScreen(true);
-                    led_module.selectFont(SystemFont5x7);
-                    led_module.drawString(6, 0, "HIGH", 4, GRAPHICS_NORMAL);
-                    led_module.drawString(2, 8, "SCORE", 5, GRAPHICS_NORMAL);
-                    delay_soft_ms(2000);
+                tlm_timer(system_ticks, gameTimer);
+            }
 
-                    led_module.clearScreen(true);
-                    led_module.selectFont(Arial_Black_16);
-                    int hxPos = (highScore < 10) ? 11 : (highScore < 100) ? 5 : 1;
-                    itoa(highScore, buf, 10);
-                    led_module.drawString(hxPos, 0, buf, strlen(buf), GRAPHICS_NORMAL);
-                    delay_soft_ms(3000);
+            // 2) Consume samples queued by the HX711 ISR, never wait for one
+            hx711_sample_t sample;
+            while (gameActive && scale.pop(sample)) {
+                for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+                    tlm_sample(TLM_RAW_SAMPLE, sample.ticks, ch, sample.value[ch]);
                 }
-
-                // After hit processed, stop the game (go back to idle)
-                gameActive = false;
-                score = 0;
-                display_score = 0;
-                has_score = false;
+                capture_add(&hitCapture, sample.value[0]);
+                handleGameLogic(sample);
             }
         } // end if gameActive
 
@@ -310,12 +750,20 @@ int main(void) {
             if ( (PIND & (1 << PD3)) == 0 ) {
                 
                 // --- YOUR GAME START LOGIC HERE ---
+                bool started = false;
+                long baseline[HX711_CHANNELS], drift[HX711_CHANNELS];
+                uint8_t sps = 0;
                 cli();
                 if (sensor_counter == 0) {
-                    USART_PrintString("Insert Coin!\r\n");
+                    USART_PrintString_P(PSTR("Insert Coin!\r\n"));
                 } else {
                     sensor_counter--;
-                    USART_PrintString("Game Started!\r\n");
+                    USART_PrintString_P(PSTR("Game Started!\r\n"));
+                    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+                        baseline[ch] = autozero_baseline(&pads[ch].zero);
+                        drift[ch] = autozero_drift(&pads[ch].zero);
+                    }
+                    sps = scale.sampleRate();
                     
                     gameActive = true;
                     gameTimer = TimerForGame;
@@ -323,9 +771,29 @@ int main(void) {
                     updateScreen = true;
                     
                     led_module.clearScreen(true);
-                    led_module.selectFont(Arial_Black_16);
+                    led_module.selectFont(Arial_Black_16, Arial_Black_16_offsets);
+                    timerField.x = -1; // force a full redraw of the first tick
+                    scale.flush();     // drop samples queued while idle
+                    capture_reset(&hitCapture);
+                    isrLatencyMax = 0;
+                    started = true;
                 }
                 sei();
+
+                // Reported from the snapshot, with the scan tick and HX711
+                // interrupts running again
+                if (started) {
+                    for (uint8_t ch = 0; ch < HX711_CHANNELS; ch++) {
+                        USART_PrintString_P(PSTR("Baseline: "));
+                        USART_PrintNumber(baseline[ch]);
+                        USART_PrintString_P(PSTR(", drift/min: "));
+                        USART_PrintNumber(drift[ch]);
+                        USART_PrintString_P(PSTR("\r\n"));
+                    }
+                    USART_PrintString_P(PSTR("HX711: "));
+                    USART_PrintNumber(sps);
+                    USART_PrintString_P(PSTR(" SPS\r\n"));
+                }
                 // ----------------------------------
 
                 // CRITICAL CHANGE: Do NOT re-enable interrupt yet!
@@ -370,16 +838,16 @@ int main(void) {
         sei();
 
         if (current_count_copy != last_printed_count) {
-            USART_PrintString("Counter: ");
             lcd_goto(0,1);
-            lcd_puts("Credit: ");
-            
-            USART_PrintNumber(current_count_copy);
+            lcd_puts_P(ui_credit);
             lcd_putnum(current_count_copy);
 
-            USART_PrintString("\r\n");
+            tlm_coin(system_ticks, current_count_copy);
             last_printed_count = current_count_copy;
         }
+
+        // TASK 4: Serial commands
+        pollSerialCommand();
     } // end main loop
 
     return 0;
@@ -393,31 +861,35 @@ void tampilkanIdleBergerak() {
         led_module.clearScreen(true); 
         led_module.selectFont(SystemFont5x7);
         
-        led_module.drawString(xPunch, 0, "PUNCH", 5, GRAPHICS_NORMAL);
+        led_module.drawString_P(xPunch, 0, ui_punch, strlen_P(ui_punch), GRAPHICS_NORMAL);
         xPunch += dirPunch;
         if (xPunch >= 3) dirPunch = -1; 
         if (xPunch <= 0) dirPunch = 1;  
         
-        led_module.drawString(xGame, 8, "GAME", 4, GRAPHICS_NORMAL);
+        led_module.drawString_P(xGame, 8, ui_game, strlen_P(ui_game), GRAPHICS_NORMAL);
         xGame += dirGame;
         if (xGame >= 9) dirGame = -1; 
         if (xGame <= 0) dirGame = 1;  
+
+        led_module.swapBuffers();
     }
 }
 
 void tampilkanHighScore() {
     led_module.clearScreen(true);
     led_module.selectFont(SystemFont5x7);
-    const char *text = "HIGHEST SCORE!   ";
-    led_module.drawMarquee(text, strlen(text), 32, 4);
+    led_module.drawMarquee_P(ui_highest_score, strlen_P(ui_highest_score), 32, 4);
+    led_module.swapBuffers();
     
     unsigned long start = system_ticks;
     while (system_ticks - start < 6000) { // Putar selama 6 detik
         unsigned long timer = system_ticks;
         bool ret = false;
         while (!ret) {
+            pollSerialCommand();
             if ((timer + 40) < system_ticks) { 
                 ret = led_module.stepMarquee(-1, 0);
+                led_module.swapBuffers();
                 timer = system_ticks;
             }
         }
@@ -426,5 +898,7 @@ void tampilkanHighScore() {
 
 void delay_soft_ms(unsigned long ms) {
     unsigned long start = system_ticks;
-    while (system_ticks - start < ms); // Busy wait
+    while (system_ticks - start < ms) {
+        pollSerialCommand(); // RX keeps arriving during the long screens
+    }
 }
@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "score.h"
+
+uint8_t score_formula = SCORE_FORMULA;
+
+// =======================================================
+// ================== INCREMENTAL ========================
+// =======================================================
+
+// Start a hit; the sample before the threshold crossing is the left
+// neighbour if the very first sample turns out to be the peak
+void score_begin(score_t *s, long prev_deviation, unsigned long prev_ticks) {
+    s->peak = prev_deviation;
+    s->before = prev_deviation;
+    s->after = prev_deviation;
+    s->need_after = false;
+    s->last = prev_deviation;
+    s->last_ticks = prev_ticks;
+    s->impulse = 0;
+}
+
+// Per sample: a compare, one multiply and an add
+void score_add(score_t *s, long deviation, unsigned long ticks) {
+    if (deviation < 0) deviation = 0;
+
+    if (deviation > s->peak) {
+        s->before = s->last;
+        s->peak = deviation;
+        s->need_after = true;
+    } else if (s->need_after) {
+        s->after = deviation;
+        s->need_after = false;
+    }
+    s->last = deviation;
+
+    // Trapezoids would need the previous sample too; rectangles on the
+    // new sample are close enough at 10-80 SPS
+    unsigned long dt = ticks - s->last_ticks;
+    if (dt > 255) dt = 255;
+    s->last_ticks = ticks;
+
+    uint32_t area = (uint32_t)(deviation >> 8) * (uint8_t)dt;
+    s->impulse = (s->impulse > 0xFFFFFFFFUL - area) ? 0xFFFFFFFFUL : s->impulse + area;
+}
+
+// =======================================================
+// ===================== RESULT ==========================
+// =======================================================
+
+// Vertex of the parabola through (-1, a), (0, b), (1, c):
+// b + (a - c)^2 / (8 * (2b - a - c)); only evaluated once per hit
+long score_peak_interp(const score_t *s) {
+    long a = s->before;
+    long b = s->peak;
+    long c = s->need_after ? s->last : s->after;
+
+    int64_t curve = 2 * (int64_t)b - a - c;
+    if (curve <= 0) return b;
+
+    int64_t slope = (int64_t)a - c;
+    return b + (long)((slope * slope) / (8 * curve));
+}
+
+long score_impulse(const score_t *s) {
+    return (long)(((uint64_t)s->impulse << 8) / SCORE_IMPULSE_MS);
+}
+
+long score_result(const score_t *s) {
+    switch (score_formula) {
+    case SCORE_PEAK:
+        return s->peak;
+    case SCORE_IMPULSE:
+        return score_impulse(s);
+    case SCORE_BLEND: {
+        int64_t mix = (int64_t)score_peak_interp(s) * SCORE_BLEND_PEAK +
+                      (int64_t)score_impulse(s) * (256 - SCORE_BLEND_PEAK);
+        return (long)(mix >> 8);
+    }
+    default:
+        return score_peak_interp(s);
+    }
+}
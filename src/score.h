@@ -0,0 +1,40 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <stdint.h>
+
+// Scoring formulas, all in raw counts above the baseline
+#define SCORE_PEAK          0   // largest sample
+#define SCORE_PEAK_INTERP   1   // parabola through the peak and its neighbours
+#define SCORE_IMPULSE       2   // area above baseline, as a SCORE_IMPULSE_MS pulse
+#define SCORE_BLEND         3   // SCORE_BLEND_PEAK/256 interp peak, rest impulse
+
+#ifndef SCORE_FORMULA
+#define SCORE_FORMULA SCORE_PEAK_INTERP
+#endif
+#ifndef SCORE_IMPULSE_MS
+#define SCORE_IMPULSE_MS 100    // impulse of a flat pulse this long = its height
+#endif
+#ifndef SCORE_BLEND_PEAK
+#define SCORE_BLEND_PEAK 192
+#endif
+
+typedef struct {
+    long peak;              // largest deviation so far
+    long before;            // sample ahead of the peak
+    long after;             // sample following the peak
+    bool need_after;
+    long last;
+    unsigned long last_ticks;
+    uint32_t impulse;       // sum of (deviation >> 8) * dt_ms
+} score_t;
+
+extern uint8_t score_formula;
+
+void score_begin(score_t *s, long prev_deviation, unsigned long prev_ticks);
+void score_add(score_t *s, long deviation, unsigned long ticks);
+long score_peak_interp(const score_t *s);
+long score_impulse(const score_t *s);
+long score_result(const score_t *s);
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <string.h>
+#include "telemetry.h"
+#include "UART.h"
+
+uint8_t telemetry_mask = TELEMETRY_MASK;
+
+static uint16_t dropped = 0;
+
+// COBS: every zero becomes the distance to the next one, so the only
+// zero on the wire is the frame delimiter. Frames are far below the
+// 254-byte block limit
+static uint8_t cobs_encode(const uint8_t *in, uint8_t len, uint8_t *out) {
+    uint8_t codePos = 0;
+    uint8_t code = 1;
+    uint8_t o = 1;
+
+    for (uint8_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codePos] = code;
+            codePos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            code++;
+        }
+    }
+    out[codePos] = code;
+    return o;
+}
+
+void tlm_send(uint8_t type, const void *payload, uint8_t len) {
+    if (!(telemetry_mask & TLM_MASK(type)) || len > TLM_MAX_PAYLOAD) return;
+
+    uint8_t frame[TLM_MAX_PAYLOAD + 2];
+    uint8_t wire[TLM_MAX_PAYLOAD + 5];
+
+    frame[0] = type;
+    memcpy(frame + 1, payload, len);
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i <= len; i++) crc = tlm_crc8(crc, frame[i]);
+    frame[len + 1] = crc;
+
+    wire[0] = 0;
+    uint8_t n = 1 + cobs_encode(frame, len + 2, wire + 1);
+    wire[n++] = 0;
+
+    // Samples never wait for the UART; drop whole frames, not bytes
+    bool sample = (type == TLM_RAW_SAMPLE || type == TLM_FILTERED_SAMPLE);
+    if (sample && USART_TxFree() < n) {
+        dropped++;
+        return;
+    }
+    for (uint8_t i = 0; i < n; i++) USART_Transmit(wire[i]);
+}
+
+void tlm_sample(uint8_t type, unsigned long ticks, uint8_t channel, long value) {
+    if (!(telemetry_mask & TLM_MASK(type))) return;
+
+    tlm_sample_t rec;
+    rec.ticks = (uint16_t)ticks;
+    rec.channel = channel;
+    memcpy(rec.value, &value, 3);   // little-endian low 24 bits
+    tlm_send(type, &rec, sizeof(rec));
+}
+
+void tlm_coin(unsigned long ticks, uint16_t credits) {
+    tlm_coin_t rec;
+    rec.ticks = ticks;
+    rec.credits = credits;
+    tlm_send(TLM_COIN_EVENT, &rec, sizeof(rec));
+}
+
+void tlm_timer(unsigned long ticks, int8_t seconds_left) {
+    tlm_timer_t rec;
+    rec.ticks = ticks;
+    rec.seconds_left = seconds_left;
+    tlm_send(TLM_TIMER_TICK, &rec, sizeof(rec));
+}
+
+uint16_t tlm_dropped(void) {
+    return dropped;
+}
@@ -0,0 +1,24 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "telemetry_proto.h"
+
+// Record types sent by default: only the sparse events, so an ASCII terminal
+// on the console port stays readable. Sample streams are turned on with
+// "set mask <n>" (raw = TLM_MASK(TLM_RAW_SAMPLE) = 2) and kept by "save";
+// raw + filtered at 80 SPS needs > 9600 baud
+#ifndef TELEMETRY_MASK
+#define TELEMETRY_MASK (TLM_MASK(TLM_HIT_SUMMARY) | TLM_MASK(TLM_COIN_EVENT) | \
+                        TLM_MASK(TLM_TIMER_TICK))
+#endif
+
+extern uint8_t telemetry_mask;
+
+void tlm_send(uint8_t type, const void *payload, uint8_t len);
+void tlm_sample(uint8_t type, unsigned long ticks, uint8_t channel, long value);
+void tlm_coin(unsigned long ticks, uint16_t credits);
+void tlm_timer(unsigned long ticks, int8_t seconds_left);
+uint16_t tlm_dropped(void);
+
+#endif
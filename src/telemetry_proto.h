@@ -0,0 +1,64 @@
+#ifndef TELEMETRY_PROTO_H
+#define TELEMETRY_PROTO_H
+
+// Binary telemetry wire format, shared by the firmware and tools/tlm_decode.
+// Plain C so the host decoder can include it as is.
+//
+// Frame:  0x00  COBS( type, payload..., crc8 )  0x00
+//
+// The leading zero ends any ASCII text printed in between, so text and
+// frames can share the port. CRC-8 (poly 0x07, init 0) covers type and
+// payload. Multi-byte fields are little-endian; i24 fields are 3-byte
+// two's complement
+
+#include <stdint.h>
+
+#define TLM_RAW_SAMPLE      0x01
+#define TLM_FILTERED_SAMPLE 0x02
+#define TLM_HIT_SUMMARY     0x03
+#define TLM_COIN_EVENT      0x04
+#define TLM_TIMER_TICK      0x05
+
+#define TLM_MASK(type)      (1 << (type))
+
+// Largest payload; a COBS block never needs more than one code byte here
+#define TLM_MAX_PAYLOAD     24
+
+typedef struct __attribute__((packed)) {
+    uint16_t ticks;         // system_ticks (ms), low 16 bits
+    uint8_t channel;
+    uint8_t value[3];       // i24 conversion
+} tlm_sample_t;             // TLM_RAW_SAMPLE and TLM_FILTERED_SAMPLE
+
+typedef struct __attribute__((packed)) {
+    uint32_t ticks;
+    uint8_t pad;
+    uint8_t formula;
+    int32_t peak;           // raw counts above baseline
+    int32_t peak_interp;
+    int32_t impulse;        // as a SCORE_IMPULSE_MS pulse height
+    int32_t score;
+    uint16_t display;
+} tlm_hit_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t ticks;
+    uint16_t credits;
+} tlm_coin_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t ticks;
+    int8_t seconds_left;
+} tlm_timer_t;
+
+static inline uint8_t tlm_crc8(uint8_t crc, uint8_t data)
+{
+    uint8_t i;
+    crc ^= data;
+    for (i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+#endif
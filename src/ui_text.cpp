@@ -0,0 +1,15 @@
+#include <avr/pgmspace.h>
+#include "ui_text.h"
+
+// LCD
+const char ui_insert_coin[] PROGMEM = "Insert Coin!";
+const char ui_credit[] PROGMEM = "Credit: ";
+
+// DMD, SystemFont5x7
+const char ui_punch[] PROGMEM = "PUNCH";
+const char ui_game[] PROGMEM = "GAME";
+const char ui_time[] PROGMEM = "TIME";
+const char ui_over[] PROGMEM = "OVER";
+const char ui_high[] PROGMEM = "HIGH";
+const char ui_score[] PROGMEM = "SCORE";
+const char ui_highest_score[] PROGMEM = "HIGHEST SCORE!   ";
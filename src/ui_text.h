@@ -0,0 +1,18 @@
+#ifndef UI_TEXT_H
+#define UI_TEXT_H
+
+#include <avr/pgmspace.h>
+
+// Player-facing text for the DMD and the LCD, kept in flash. Draw with
+// drawString_P / drawMarquee_P / lcd_puts_P and strlen_P
+extern const char ui_insert_coin[] PROGMEM;
+extern const char ui_credit[] PROGMEM;
+extern const char ui_punch[] PROGMEM;
+extern const char ui_game[] PROGMEM;
+extern const char ui_time[] PROGMEM;
+extern const char ui_over[] PROGMEM;
+extern const char ui_high[] PROGMEM;
+extern const char ui_score[] PROGMEM;
+extern const char ui_highest_score[] PROGMEM;
+
+#endif
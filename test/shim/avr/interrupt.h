@@ -0,0 +1,10 @@
+#ifndef SHIM_AVR_INTERRUPT_H
+#define SHIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+// Interrupts stay off (SREG = 0): swapBuffers() swaps at once
+static inline void cli(void) {}
+static inline void sei(void) {}
+
+#endif
@@ -0,0 +1,42 @@
+// Host stand-in for the ATmega328P registers the DMD driver touches, for
+// the native test environment. Storage lives in the test.
+#ifndef SHIM_AVR_IO_H
+#define SHIM_AVR_IO_H
+
+#include <stdint.h>
+
+// SPI data register: every byte written is handed to the test
+struct ShimSpiData {
+    ShimSpiData &operator=(uint8_t data);
+};
+
+// SPI status register: a transfer always completes at once
+struct ShimSpiStatus {
+    ShimSpiStatus &operator=(uint8_t) { return *this; }
+    operator uint8_t() const { return 1 << 7; } // SPIF
+};
+
+extern ShimSpiData SPDR;
+extern ShimSpiStatus SPSR;
+extern volatile uint8_t SPCR;
+extern volatile uint8_t PORTB, DDRB, PINB;
+extern volatile uint8_t PORTD, DDRD;
+extern volatile uint8_t SREG;
+extern volatile uint16_t TCNT1, OCR1A;
+
+#define SPIF    7
+#define SPI2X   0
+#define SPE     6
+#define MSTR    4
+#define SPR0    0
+#define SREG_I  7
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB5 5
+#define PD6 6
+#define PD7 7
+
+#endif
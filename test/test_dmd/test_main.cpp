@@ -0,0 +1,176 @@
+// DMD driver on the host: frames are decoded from the bytes the scan
+// routine shifts out, so the tests see exactly what the panels would.
+//
+//   pio test -e native
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "DMD.h"
+#include "SystemFont5x7.h"
+
+// Register storage for test/shim/avr/io.h
+ShimSpiData SPDR;
+ShimSpiStatus SPSR;
+volatile uint8_t SPCR;
+volatile uint8_t PORTB, DDRB, PINB = 0xFF;   // SS high: the bus is ours
+volatile uint8_t PORTD, DDRD;
+volatile uint8_t SREG;
+volatile uint16_t TCNT1, OCR1A = 499;
+
+#define MAX_PANELS 4
+#define MAX_WIDTH  (DMD_PIXELS_ACROSS * MAX_PANELS)
+#define MAX_HEIGHT (DMD_PIXELS_DOWN * MAX_PANELS)
+
+static uint8_t wire[MAX_PANELS * 16];
+static uint16_t wireLen;
+
+ShimSpiData &ShimSpiData::operator=(uint8_t data)
+{
+    if (wireLen < sizeof(wire)) wire[wireLen] = data;
+    wireLen++;
+    return *this;
+}
+
+typedef bool frame_t[MAX_HEIGHT][MAX_WIDTH];
+
+// One full frame (4 scan rows) of the buffer being shown. On the wire a
+// row is, per byte column of the chain, the bytes of panel rows 12+p, 8+p,
+// 4+p and p, where p is the scan phase; a 0 bit is a lit LED
+static void scanFrame(DMD &dmd, uint8_t wide, uint8_t high, frame_t &frame)
+{
+    uint8_t total = wide * high;
+    memset(frame, 0, sizeof(frame_t));
+
+    for (uint8_t phase = 0; phase < 4; phase++) {
+        wireLen = 0;
+        dmd.scanDisplayBySPI();
+        TEST_ASSERT_EQUAL_UINT16(total * 16, wireLen);
+
+        for (uint16_t n = 0; n < wireLen; n++) {
+            uint8_t column = n / 4;                 // chain byte column
+            uint8_t panelRow = phase + 4 * (3 - (n & 3));
+            uint8_t panel = column / 4;
+            int x = (panel % wide) * DMD_PIXELS_ACROSS + (column % 4) * 8;
+            int y = (panel / wide) * DMD_PIXELS_DOWN + panelRow;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                frame[y][x + bit] = !(wire[n] & (0x80 >> bit));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// writePixel against a plain row-major image (golden model)
+// ---------------------------------------------------------------------------
+
+// The graphics modes on one pixel, lit = true
+static bool modelPixel(bool lit, uint8_t mode, bool pixel)
+{
+    switch (mode) {
+    case GRAPHICS_NORMAL:  return pixel;
+    case GRAPHICS_INVERSE: return !pixel;
+    case GRAPHICS_TOGGLE:  return pixel ? !lit : lit;
+    case GRAPHICS_OR:      return pixel ? true : lit;
+    case GRAPHICS_NOR:     return pixel ? false : lit;
+    }
+    return lit;
+}
+
+// Random pixels in every mode, a few of them off screen; what the chain
+// receives must match the model for whatever RAM layout the driver uses
+static void checkWritePixel(uint8_t wide, uint8_t high)
+{
+    DMD dmd(wide, high, false);
+    static frame_t expected, frame;
+    int width = wide * DMD_PIXELS_ACROSS, height = high * DMD_PIXELS_DOWN;
+    uint32_t seed = 12345;
+
+    dmd.clearScreen(true);
+    memset(expected, 0, sizeof(expected));
+
+    for (int i = 0; i < 4000; i++) {
+        seed = seed * 1103515245 + 12345;
+        int x = (seed >> 8) % (width + 2);
+        int y = (seed >> 20) % (height + 1);
+        uint8_t mode = (seed >> 4) % 5;
+        bool pixel = (seed >> 30) & 1;
+
+        dmd.writePixel(x, y, mode, pixel);
+        if (x < width && y < height) expected[y][x] = modelPixel(expected[y][x], mode, pixel);
+    }
+
+    scanFrame(dmd, wide, high, frame);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (frame[y][x] != expected[y][x]) {
+                char msg[64];
+                snprintf(msg, sizeof(msg), "%dx%d: pixel (%d, %d) is %s", wide, high, x, y,
+                         frame[y][x] ? "lit" : "dark");
+                TEST_FAIL_MESSAGE(msg);
+            }
+        }
+    }
+}
+
+void test_write_pixel_1x1(void) { checkWritePixel(1, 1); }
+void test_write_pixel_2x1(void) { checkWritePixel(2, 1); }
+void test_write_pixel_1x2(void) { checkWritePixel(1, 2); }
+void test_write_pixel_2x2(void) { checkWritePixel(2, 2); }
+void test_write_pixel_4x1(void) { checkWritePixel(4, 1); }
+
+// ---------------------------------------------------------------------------
+// Marquee on a double-buffered display
+// ---------------------------------------------------------------------------
+
+// What was on screen before the marquee (the count-up digits) must not
+// come back in the buffer that was swapped out
+void test_marquee_clears_both_buffers(void)
+{
+    DMD dmd(1, 1, true);
+    frame_t frame;
+
+    dmd.drawFilledBox(0, 0, 31, 15, GRAPHICS_NORMAL);
+    dmd.swapBuffers(true);
+
+    dmd.clearScreen(true);
+    dmd.selectFont(SystemFont5x7);
+    const char *text = "HIGHEST SCORE!   ";
+    dmd.drawMarquee(text, strlen(text), 32, 4);
+    dmd.swapBuffers();
+
+    // Marquee band: the font height plus the gap row, from y = 4
+    for (int step = 0; step < 80; step++) {
+        dmd.stepMarquee(-1, 0);
+        dmd.swapBuffers();
+        scanFrame(dmd, 1, 1, frame);
+
+        for (int y = 0; y < DMD_PIXELS_DOWN; y++) {
+            if (y >= 4 && y < 4 + 8) continue;
+            for (int x = 0; x < DMD_PIXELS_ACROSS; x++) {
+                if (frame[y][x]) {
+                    char msg[48];
+                    snprintf(msg, sizeof(msg), "step %d: stale pixel (%d, %d)", step, x, y);
+                    TEST_FAIL_MESSAGE(msg);
+                }
+            }
+        }
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_write_pixel_1x1);
+    RUN_TEST(test_write_pixel_2x1);
+    RUN_TEST(test_write_pixel_1x2);
+    RUN_TEST(test_write_pixel_2x2);
+    RUN_TEST(test_write_pixel_4x1);
+    RUN_TEST(test_marquee_clears_both_buffers);
+    return UNITY_END();
+}
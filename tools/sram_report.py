@@ -0,0 +1,66 @@
+# PlatformIO post-build step, see extra_scripts in platformio.ini.
+#
+# Prints the static SRAM use of the linked image (.data, .bss, .noinit),
+# what is left for heap and stack, the largest RAM symbols, and the change
+# since the previous build of the same environment.
+
+Import("env")
+
+import os
+import subprocess
+
+TOP_SYMBOLS = 10
+RAM_SECTIONS = (".data", ".bss", ".noinit")
+
+
+def tool(name):
+    # avr-gcc -> avr-size / avr-nm, from the same toolchain
+    return env.subst("$CC").replace("gcc", name)
+
+
+def section_sizes(elf):
+    out = subprocess.check_output([tool("size"), "-A", elf], universal_newlines=True)
+    sizes = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in RAM_SECTIONS:
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def ram_symbols(elf):
+    out = subprocess.check_output([tool("nm"), "-S", "-C", "--size-sort", elf],
+                                  universal_newlines=True)
+    symbols = []
+    for line in out.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4 or fields[2] not in "bBdD":
+            continue
+        symbols.append((int(fields[1], 16), fields[3]))
+    return sorted(symbols, reverse=True)[:TOP_SYMBOLS]
+
+
+def sram_report(source, target, env):
+    elf = str(target[0])
+    ram = int(env.BoardConfig().get("upload.maximum_ram_size", 2048))
+    sizes = section_sizes(elf)
+    used = sum(sizes.values())
+
+    history = os.path.join(env.subst("$BUILD_DIR"), "sram_report.txt")
+    previous = None
+    if os.path.isfile(history):
+        with open(history) as f:
+            previous = int(f.read().strip() or 0)
+    with open(history, "w") as f:
+        f.write("%d\n" % used)
+
+    print("SRAM: %s" % ", ".join("%s %d" % (s, sizes.get(s, 0)) for s in RAM_SECTIONS))
+    line = "SRAM: %d of %d bytes static, %d left for heap and stack" % (used, ram, ram - used)
+    if previous is not None and previous != used:
+        line += " (%+d since last build)" % (used - previous)
+    print(line)
+    for size, name in ram_symbols(elf):
+        print("  %5d  %s" % (size, name))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", sram_report)
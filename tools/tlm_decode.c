@@ -0,0 +1,248 @@
+/*
+ * Decoder for the firmware's binary telemetry (src/telemetry_proto.h).
+ *
+ *   tlm_decode [device|file [baud]]
+ *
+ * Reads stdin when no path is given. With a baud rate the path is put in
+ * raw mode at that speed first. Frames are printed one record per line;
+ * anything between frames that is not a valid frame is ASCII text from
+ * the firmware and is echoed prefixed with "# ".
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <asm/ioctls.h>
+#endif
+
+#include "../src/telemetry_proto.h"
+
+#define MAX_CHUNK 512
+
+static unsigned long frames, crc_errors;
+
+static speed_t baud_constant(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B250000
+    case 250000: return B250000;
+#endif
+    case 500000: return B500000;
+    case 1000000: return B1000000;
+    default: return 0;
+    }
+}
+
+#ifdef __linux__
+/* Rates without a Bxxx constant (250000). <asm/termbits.h> clashes with
+ * <termios.h>, so the kernel's termios2 layout is spelled out here */
+struct termios2 {
+    tcflag_t c_iflag, c_oflag, c_cflag, c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed, c_ospeed;
+};
+#ifndef BOTHER
+#define BOTHER 0010000
+#endif
+
+static int set_custom_speed(int fd, long baud)
+{
+    struct termios2 t2;
+    if (ioctl(fd, TCGETS2, &t2) < 0)
+        return -1;
+    t2.c_cflag &= ~CBAUD;
+    t2.c_cflag |= BOTHER;
+    t2.c_ispeed = t2.c_ospeed = baud;
+    return ioctl(fd, TCSETS2, &t2);
+}
+#endif
+
+static int open_input(const char *path, long baud)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    if (baud) {
+        struct termios tio;
+        speed_t speed = baud_constant(baud);
+        int custom = !speed;
+        if (custom) {
+#if defined(__linux__)
+            speed = B38400;     /* placeholder, replaced below */
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+            speed = (speed_t)baud;  /* speed_t is the rate itself */
+            custom = 0;
+#else
+            fprintf(stderr, "unsupported baud rate %ld\n", baud);
+            exit(1);
+#endif
+        }
+        if (tcgetattr(fd, &tio) < 0) {
+            perror("tcgetattr");
+            exit(1);
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+            perror("tcsetattr");
+            exit(1);
+        }
+#ifdef __linux__
+        if (custom && set_custom_speed(fd, baud) < 0) {
+            perror("TCSETS2");
+            exit(1);
+        }
+#endif
+    }
+    return fd;
+}
+
+/* Returns the decoded length, or -1 if the chunk is not valid COBS */
+static int cobs_decode(const uint8_t *in, int len, uint8_t *out)
+{
+    int i = 0, o = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return -1;
+        for (int k = 1; k < code; k++)
+            out[o++] = in[i++];
+        if (code < 0xFF && i < len)
+            out[o++] = 0;
+    }
+    return o;
+}
+
+static int32_t i24(const uint8_t *p)
+{
+    int32_t v = p[0] | (p[1] << 8) | ((int32_t)p[2] << 16);
+    return (v & 0x800000) ? v - 0x1000000 : v;
+}
+
+static int print_record(const uint8_t *f, int len)
+{
+    uint8_t type = f[0];
+    const uint8_t *p = f + 1;
+    int plen = len - 2;
+
+    switch (type) {
+    case TLM_RAW_SAMPLE:
+    case TLM_FILTERED_SAMPLE: {
+        tlm_sample_t r;
+        if (plen != sizeof(r)) return 0;
+        memcpy(&r, p, sizeof(r));
+        printf("%s t=%u ch=%u value=%d\n",
+               type == TLM_RAW_SAMPLE ? "raw" : "filtered",
+               r.ticks, r.channel, i24(r.value));
+        return 1;
+    }
+    case TLM_HIT_SUMMARY: {
+        tlm_hit_t r;
+        if (plen != sizeof(r)) return 0;
+        memcpy(&r, p, sizeof(r));
+        printf("hit t=%u pad=%u formula=%u peak=%d interp=%d impulse=%d score=%d display=%u\n",
+               r.ticks, r.pad, r.formula, r.peak, r.peak_interp, r.impulse,
+               r.score, r.display);
+        return 1;
+    }
+    case TLM_COIN_EVENT: {
+        tlm_coin_t r;
+        if (plen != sizeof(r)) return 0;
+        memcpy(&r, p, sizeof(r));
+        printf("coin t=%u credits=%u\n", r.ticks, r.credits);
+        return 1;
+    }
+    case TLM_TIMER_TICK: {
+        tlm_timer_t r;
+        if (plen != sizeof(r)) return 0;
+        memcpy(&r, p, sizeof(r));
+        printf("timer t=%u left=%d\n", r.ticks, r.seconds_left);
+        return 1;
+    }
+    default:
+        return 0;
+    }
+}
+
+static void print_text(const uint8_t *chunk, int len)
+{
+    printf("# ");
+    for (int i = 0; i < len; i++) {
+        uint8_t c = chunk[i];
+        if (c == '\r')
+            continue;
+        if (c == '\n' && i + 1 < len)
+            printf("\n# ");
+        else if (c == '\n')
+            continue;
+        else
+            putchar(c >= 0x20 && c < 0x7F ? c : '.');
+    }
+    putchar('\n');
+}
+
+static void handle_chunk(const uint8_t *chunk, int len)
+{
+    uint8_t frame[MAX_CHUNK];
+    int n;
+
+    if (len == 0)
+        return;
+
+    n = cobs_decode(chunk, len, frame);
+    if (n >= 2 && n <= TLM_MAX_PAYLOAD + 2) {
+        uint8_t crc = 0;
+        for (int i = 0; i < n - 1; i++)
+            crc = tlm_crc8(crc, frame[i]);
+        if (crc == frame[n - 1] && print_record(frame, n)) {
+            frames++;
+            return;
+        }
+        if (crc != frame[n - 1] && frame[0] >= TLM_RAW_SAMPLE && frame[0] <= TLM_TIMER_TICK)
+            crc_errors++;
+    }
+    print_text(chunk, len);
+}
+
+int main(int argc, char **argv)
+{
+    int fd = 0;
+    uint8_t buf[256], chunk[MAX_CHUNK];
+    int clen = 0;
+    ssize_t n;
+
+    if (argc > 1)
+        fd = open_input(argv[1], argc > 2 ? atol(argv[2]) : 0);
+
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] == 0) {
+                handle_chunk(chunk, clen);
+                clen = 0;
+            } else if (clen < MAX_CHUNK) {
+                chunk[clen++] = buf[i];
+            }
+        }
+        fflush(stdout);
+    }
+    handle_chunk(chunk, clen);
+
+    fprintf(stderr, "%lu frames, %lu crc errors\n", frames, crc_errors);
+    return 0;
+}